@@ -0,0 +1,9 @@
+function setloadsbulk(names, loads)
+
+for i=1:size(names,1)
+    set_param(names{i}, 'ActivePower', num2str(loads(i,1)), ...
+                        'InductivePower', num2str(loads(i,2)), ...
+                        'CapacitivePower', num2str(loads(i,3)));
+end
+
+end
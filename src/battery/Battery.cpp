@@ -36,14 +36,14 @@ POSSIBILITY OF SUCH DAMAGE.
 
 // Upload battery specs, set initial values, randomness to initial SOC if
 // specified by config
-Battery::Battery(Config* config) {
+Battery::Battery(Config* config, RandomStream random) {
     batteryFile = config->getString("batterydata");
     simInterval = config->getInt("simulationinterval");
     
     uploadCharacteristics(batteryFile);
     
     // Random initial capacity of battery
-    double randCapacity = utility::randomNormal(config->getRandomParams("batteryrandom"));
+    double randCapacity = random.normal(config->getRandomParams("batteryrandom"));
     capacity = config->getDouble("batterystart") + randCapacity;
     if(capacity > C_SafeUpper)
         capacity = C_SafeUpper;
@@ -54,6 +54,18 @@ Battery::Battery(Config* config) {
 Battery::~Battery() {
 }
 
+void Battery::saveState(std::ostream &out) {
+    utility::writeBinary(out, capacity);
+    utility::writeBinary(out, SOC);
+    utility::writeBinary(out, SOC_last);
+}
+
+void Battery::loadState(std::istream &in) {
+    utility::readBinary(in, capacity);
+    utility::readBinary(in, SOC);
+    utility::readBinary(in, SOC_last);
+}
+
 
 void Battery::uploadCharacteristics(std::string filename) {  
    std::string line;
@@ -111,8 +111,8 @@ public:
     
     
 public:
-    /** Constructor */
-    Battery(Config* config);
+    /** Constructor.  Random initial capacity is drawn from given stream. */
+    Battery(Config* config, RandomStream random);
     
     /** Destructor */
     virtual ~Battery();
@@ -125,6 +125,12 @@ public:
     
     /** Display battery details. */
     void displayCharacteristics();
+    
+    /** Write capacity and SOC to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read capacity and SOC from checkpoint. */
+    void loadState(std::istream &in);
 
 
 private:
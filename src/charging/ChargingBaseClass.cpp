@@ -35,7 +35,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "ChargingBaseClass.h"
 
 
-ChargingBaseClass::ChargingBaseClass(Config* config, GridModel gridModel) {
+ChargingBaseClass::ChargingBaseClass(Config* config, const GridModel &gridModel) {
     name = config->getConfigVar("chargingalgorithm");
     std::cout << " - Using charging algorithm: " << name << std::endl;
 }
@@ -43,3 +43,9 @@ ChargingBaseClass::ChargingBaseClass(Config* config, GridModel gridModel) {
 ChargingBaseClass::~ChargingBaseClass() {
 }
 
+void ChargingBaseClass::saveState(std::ostream &out) {
+}
+
+void ChargingBaseClass::loadState(std::istream &in) {
+}
+
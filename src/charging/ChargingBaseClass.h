@@ -58,16 +58,23 @@ protected:
 
 public:
     /** Constructor */
-    ChargingBaseClass(Config* config, GridModel gridModel);
+    ChargingBaseClass(Config* config, const GridModel &gridModel);
     
     /** Destructor */
-    ~ChargingBaseClass();
+    virtual ~ChargingBaseClass();
     
     /** Set charge rates of all vehicles at current date and time. */
     virtual void setAllChargeRates(DateTime datetime, GridModel &gridModel) = 0;
     
     /** Set charge rates of one vehicle at current date and time.  */
     virtual void setOneChargeRate(DateTime datetime, GridModel &gridModel, int vehicleID) = 0;
+    
+    /** Write any internal state of the charging algorithm to checkpoint.  
+      * Algorithms that keep state between intervals should override this. */
+    virtual void saveState(std::ostream &out);
+    
+    /** Read internal state of the charging algorithm from checkpoint. */
+    virtual void loadState(std::istream &in);
 };
 
 
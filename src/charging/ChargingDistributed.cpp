@@ -125,7 +125,7 @@ void ChargingDistributed::setAllChargeRates(DateTime datetime, GridModel &gridMo
          //         << std::setw(3) << std::right << std::setiosflags(std::ios::fixed) << N << " = " 
          //         << std::setw(3) << std::right << std::setiosflags(std::ios::fixed) << P;
         
-        if(utility::randomUniform(0,1) < P_applied) {
+        if(it->second->random.uniform() < P_applied) {
             it->second->chargeRate = maxChargeRate;
             it->second->isCharging = true;
             it->second->switchon = true;
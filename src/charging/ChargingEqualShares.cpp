@@ -33,7 +33,7 @@ POSSIBILITY OF SUCH DAMAGE.
 */
 #include "ChargingEqualShares.h"
 
-ChargingEqualShares::ChargingEqualShares(Config* config, GridModel gridModel) :
+ChargingEqualShares::ChargingEqualShares(Config* config, const GridModel &gridModel) :
 ChargingBaseClass(config, gridModel){
     maxChargeRate = config->getDouble("maxchargerate");
 }
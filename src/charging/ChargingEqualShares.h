@@ -59,7 +59,7 @@ private:
     
 public:   
     /** Constructor */
-    ChargingEqualShares(Config* config, GridModel gridModel);
+    ChargingEqualShares(Config* config, const GridModel &gridModel);
     
     /** Destructor */
     ~ChargingEqualShares();
@@ -34,7 +34,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "ChargingTOU.h"
 
-ChargingTOU::ChargingTOU(Config* config, GridModel gridModel) :
+ChargingTOU::ChargingTOU(Config* config, const GridModel &gridModel) :
 ChargingBaseClass(config, gridModel){
     maxChargeRate = config->getDouble("maxchargerate");
     chargeStart = 23;
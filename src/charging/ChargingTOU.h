@@ -60,7 +60,7 @@ private:
     
 public:   
     /** Constructor */
-    ChargingTOU(Config* config, GridModel gridModel);
+    ChargingTOU(Config* config, const GridModel &gridModel);
     
     /** Destructor */
     ~ChargingTOU();
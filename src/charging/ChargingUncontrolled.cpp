@@ -34,7 +34,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "ChargingUncontrolled.h"
 
-ChargingUncontrolled::ChargingUncontrolled(Config* config, GridModel gridModel) :
+ChargingUncontrolled::ChargingUncontrolled(Config* config, const GridModel &gridModel) :
 ChargingBaseClass(config, gridModel){
     maxChargeRate = config->getDouble("maxchargerate");
 }
@@ -56,7 +56,7 @@ private:
     
 public:   
     /** Constructor */
-    ChargingUncontrolled(Config* config, GridModel gridModel);
+    ChargingUncontrolled(Config* config, const GridModel &gridModel);
     
     /** Destructor */
     ~ChargingUncontrolled();
@@ -0,0 +1,134 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "CompiledNetwork.h"
+
+
+CompiledNetwork::CompiledNetwork() {
+    numPoles = 0;
+    numHouses = 0;
+}
+
+CompiledNetwork::~CompiledNetwork() {
+}
+
+void CompiledNetwork::compile(FeederPole* root,
+                              std::map<std::string,FeederPole*> &poleMap,
+                              std::map<std::string,Household*> &households) {
+    poles.clear();
+    parent.clear();
+    segments.clear();
+    segmentR.clear();
+    segmentL.clear();
+    segmentC.clear();
+    poleIndex.clear();
+    
+    // Breadth-first traversal from root
+    poles.push_back(root);
+    parent.push_back(-1);
+    segments.push_back(NULL);
+    segmentR.push_back(0);
+    segmentL.push_back(0);
+    segmentC.push_back(0);
+    poleIndex[root] = 0;
+    
+    FeederPole* currPole;
+    FeederLineSegment* currSegment;
+    for(int i=0; i<poles.size(); i++) {
+        currPole = poles.at(i);
+        for(std::vector<FeederLineSegment*>::iterator it=currPole->childLineSegments.begin(); it!=currPole->childLineSegments.end(); ++it) {
+            currSegment = *it;
+            if(currSegment->childPole == NULL)
+                continue;
+            poleIndex[currSegment->childPole] = poles.size();
+            poles.push_back(currSegment->childPole);
+            parent.push_back(i);
+            segments.push_back(currSegment);
+            segmentR.push_back(currSegment->line.length * currSegment->line.resistance);
+            segmentL.push_back(currSegment->line.length * currSegment->line.inductance);
+            segmentC.push_back(currSegment->line.length * currSegment->line.capacitance);
+        }
+    }
+    numPoles = poles.size();
+    
+    // Households, and the poles they are connected to.  Houses without a 
+    // parent pole are assumed to be connected at the root.
+    houses.clear();
+    housePole.clear();
+    housePhase.clear();
+    serviceR.clear();
+    serviceL.clear();
+    serviceC.clear();
+    
+    Household* currHouse;
+    int pole;
+    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) {
+        currHouse = it->second;
+        pole = 0;
+        if(currHouse->hasParent && poleMap.find(currHouse->parentPoleName) != poleMap.end())
+            pole = findPole(poleMap[currHouse->parentPoleName]);
+        
+        houses.push_back(currHouse);
+        housePole.push_back(pole < 0 ? 0 : pole);
+        housePhase.push_back((int)currHouse->phase);
+        serviceR.push_back(currHouse->serviceLine.length * currHouse->serviceLine.resistance);
+        serviceL.push_back(currHouse->serviceLine.length * currHouse->serviceLine.inductance);
+        serviceC.push_back(currHouse->serviceLine.length * currHouse->serviceLine.capacitance);
+    }
+    numHouses = houses.size();
+    
+    houseP.assign(numHouses, 0);
+    houseQ.assign(numHouses, 0);
+}
+
+void CompiledNetwork::updateLoads(const double* active, const double* inductive, const double* capacitive) {
+    if(active == NULL) {
+        houseP.assign(numHouses, 0);
+        houseQ.assign(numHouses, 0);
+        return;
+    }
+    
+    // Capacitive power is stored as negative reactive power
+    for(int h=0; h<numHouses; h++) {
+        houseP[h] = active[h];
+        houseQ[h] = inductive[h] + capacitive[h];
+    }
+}
+
+int CompiledNetwork::findPole(FeederPole* pole) {
+    std::map<FeederPole*, int>::iterator it = poleIndex.find(pole);
+    if(it == poleIndex.end())
+        return -1;
+    return it->second;
+}
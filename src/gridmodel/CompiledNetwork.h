@@ -0,0 +1,128 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef COMPILEDNETWORK_H
+#define	COMPILEDNETWORK_H
+
+#include <iostream>
+#include <vector>
+#include <map>
+
+#include "../household/Household.h"
+#include "Feeder.h"
+
+
+/** A flattened view of the network tree, for fast traversal.  Poles are 
+  * stored in breadth-first order from the root, so that a single forward loop
+  * over the arrays visits every parent before its children, and a single
+  * backward loop visits every child before its parent.  All per-pole and 
+  * per-household quantities are kept in separate dense arrays 
+  * (struct-of-arrays).  Built once after the network model has been 
+  * extracted; the tree itself remains the authoritative model. */
+class CompiledNetwork {
+
+public:
+    /** Number of poles in the network. */
+    int numPoles;
+    
+    /** Number of households in the network. */
+    int numHouses;
+    
+    /** All poles, in breadth-first order (root first). */
+    std::vector<FeederPole*> poles;
+    
+    /** Index of each pole's parent pole, -1 for root. */
+    std::vector<int> parent;
+    
+    /** Line segment connecting each pole to its parent, NULL for root. */
+    std::vector<FeederLineSegment*> segments;
+    
+    /** Total resistance of each pole's parent line segment (single conductor). */
+    std::vector<double> segmentR;
+    
+    /** Total inductance of each pole's parent line segment (single conductor). */
+    std::vector<double> segmentL;
+    
+    /** Total capacitance of each pole's parent line segment (single conductor). */
+    std::vector<double> segmentC;
+    
+    /** All households, in the order in which they are mapped to their names. */
+    std::vector<Household*> houses;
+    
+    /** Index of pole each household is connected to. */
+    std::vector<int> housePole;
+    
+    /** Phase each household is connected to. */
+    std::vector<int> housePhase;
+    
+    /** Total resistance of each household's service line (single conductor). */
+    std::vector<double> serviceR;
+    
+    /** Total inductance of each household's service line (single conductor). */
+    std::vector<double> serviceL;
+    
+    /** Total capacitance of each household's service line (single conductor). */
+    std::vector<double> serviceC;
+    
+    /** Active power demand of each household, as at last call to updateLoads. */
+    std::vector<double> houseP;
+    
+    /** Reactive power demand of each household, as at last call to updateLoads. */
+    std::vector<double> houseQ;
+    
+public:
+    /** Constructor */
+    CompiledNetwork();
+    
+    /** Destructor */
+    virtual ~CompiledNetwork();
+    
+    /** Build flattened arrays from the network tree. */
+    void compile(FeederPole* root,
+                 std::map<std::string,FeederPole*> &poleMap,
+                 std::map<std::string,Household*> &households);
+    
+    /** Copy given household demand (in order of houses) into houseP, houseQ.
+      * Demand is zero if none is given. */
+    void updateLoads(const double* active, const double* inductive, const double* capacitive);
+    
+    /** Index of given pole, or -1 if it is not part of the network. */
+    int findPole(FeederPole* pole);
+    
+private:
+    /** Index of each pole, mapped to the pole. */
+    std::map<FeederPole*, int> poleIndex;
+};
+
+#endif	/* COMPILEDNETWORK_H */
@@ -134,9 +134,14 @@ public:
         line.capacitance = 0.0;
         line.length = 0.0;
         voltageUnbalance = 0.0;
+        parentPole = NULL;
+        childPole = NULL;
     };
     
     FeederLineSegment(std::string n, double r, double i, double c, double l) {
+        voltageUnbalance = 0.0;
+        parentPole = NULL;
+        childPole = NULL;
         set(n, r, i, c, l);
     };
     
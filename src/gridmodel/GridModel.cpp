@@ -38,22 +38,49 @@ POSSIBILITY OF SUCH DAMAGE.
 
 
 GridModel::GridModel() {
+    root = NULL;
+    transformer = NULL;
+    loadFlowCache = NULL;
 }
 
 GridModel::~GridModel() {
-    // If a temporary directory was created for temp data storage, delete
-    // directory and its contents
-    boost::filesystem::path tempPath(tempDir);
-    boost::filesystem::remove_all(tempPath);
+    // All network components are owned by the grid model
+    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
+        delete it->second;
+    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it)
+        delete it->second;
+    for(std::map<std::string,FeederLineSegment*>::iterator it = lineSegments.begin(); it != lineSegments.end(); ++it)
+        delete it->second;
+    for(std::map<std::string,FeederPole*>::iterator it = poles.begin(); it != poles.end(); ++it)
+        delete it->second;
+    delete transformer;
+    delete loadFlowCache;
 }
 
-void GridModel::initialise(Config* config, LoadFlowInterface* lf) {
+void GridModel::initialise(Config* config, LoadFlowInterface* lf, unsigned int seed) {
     // Save some global parameters locally for convenience
     baseVoltage = config->getDouble("basevoltage");
     averagePowerFactor = config->getDouble("powerfactor");
     evPenetration = config->getInt("evpenetration");
     minVoltage = config->getInt("minvoltage");
+    incrementalLoadFlow = config->getBool("incrementalloadflow");
+    frequency = config->getDouble("frequency");
+    sensitivityDrift = config->getDouble("sensitivitydrift");
+    simInterval = config->getInt("simulationinterval");
+    finishTime.set(config->getConfigVar("finishtime"));
     sumHouseholdLoads = 0;
+    loadRows = 0;
+    loadRow = 0;
+    networkData.iterations = 0;
+    lastLoadFlowCached = false;
+    randomSeed = seed;
+    random = RandomStream(randomSeed, "gridmodel", 0);
+    
+    // Create load flow result cache, if required
+    loadFlowCache = NULL;
+    if(config->getBool("loadflowcache"))
+        loadFlowCache = new LoadFlowCache(config->getDouble("loadflowcachetol"), 
+                                          config->getDouble("loadflowcachemem"));
     
     // set handle to loadflow
     loadflow = lf;
@@ -68,12 +95,22 @@ void GridModel::initialise(Config* config, LoadFlowInterface* lf) {
     // map to NMI for convenience (sometimes houses need to be searched by NMI)
     buildHouseholdNMImap();
     
+    // Each household draws from its own random stream
+    for(std::map<std::string,Household*>::iterator it=households.begin(); it!=households.end(); ++it)
+        it->second->random = RandomStream(randomSeed, "household", it->second->NMI);
+    
     // For each household, set demand model type (important for ensuring the right
     // demand values are used
     setHouseholdDemandModel(config->getString("demandmodel"));
     
+    // Flatten network tree for fast traversal
+    network.compile(root, poles, households);
+    
     // Determine total impedance from transformer to every house
-    calculateHouseholdZ(root, 0, 0);
+    calculateHouseholdZ();
+    
+    // Let load flow interface know which components demand will be set for
+    registerDemandComponents();
     
     // Update transformer capacity if config is different from value
     // extracted from model
@@ -123,15 +160,13 @@ void GridModel::addVehicles(Config* config) {
     }
 
     if(generateRandom) {
-        srand((unsigned int)(time(NULL)));
-
         // Calculate number of EVs
         numEVs = std::min(households.size()*evPenetration/100, households.size());
         std::cout << " - Randomly adding " << numEVs << " vehicles (" << evPenetration << "%) ..." << std::endl;
 
         // Randomly pick from households to associate EVs
         for(size_t i=1; i<=households.size(); i++) indexVector.push_back(i);
-        utility::random_unique(indexVector.begin(), indexVector.end(), numEVs);
+        utility::random_unique(indexVector.begin(), indexVector.end(), numEVs, random);
     }
     
     else { // take vehicle locations from file
@@ -141,7 +176,10 @@ void GridModel::addVehicles(Config* config) {
             indexVector.push_back(utility::string2int(line));
         }
         evPenetration = 100*numEVs/households.size();
-        config->setConfigVar("evpenetration", utility::int2string(evPenetration));
+        
+        // Only write if changed, as ensemble members may be reading config
+        if(config->getInt("evpenetration") != evPenetration)
+            config->setConfigVar("evpenetration", utility::int2string(evPenetration));
         std::cout << " - Added " << numEVs << " vehicles (" << evPenetration << "%) ..." << std::endl;
     }
 
@@ -154,7 +192,7 @@ void GridModel::addVehicles(Config* config) {
         vehicleName = currHousehold->name;
         vehicleName.append("_EV");
 
-        newVehicle = new Vehicle(config, nmi, vehicleName, currHousehold->name);
+        newVehicle = new Vehicle(config, nmi, vehicleName, currHousehold->name, RandomStream(randomSeed, "vehicle", nmi));
         newVehicle->componentName = currHousehold->componentName.substr(0, currHousehold->componentName.find_last_of('/')+1);
         newVehicle->componentName.append("Vehicle");
         //std::cout << "Vehicle " << newVehicle->name << " will have component name " << newVehicle->componentName << std::endl;
@@ -163,6 +201,7 @@ void GridModel::addVehicles(Config* config) {
     } 
 
     buildVehicleNMImap();
+    registerDemandComponents();
 }
 
 void GridModel::updateVehicleBatteries() {
@@ -179,19 +218,62 @@ void GridModel::updateVehicleBatteries() {
 }
 
 void GridModel::generateAllHouseholdLoads(DateTime currTime) {
+    // Find row of current interval, precompute next day of loads if needed
+    long offset = currTime.minutesSinceEpoch() - loadStart.minutesSinceEpoch();
+    if(loadRows == 0 || offset < 0 || offset % simInterval != 0 || offset/simInterval >= loadRows) {
+        precomputeHouseholdLoads(currTime);
+        offset = 0;
+    }
+    loadRow = offset/simInterval;
+    
     std::cout << " - Generating all household loads ...";
     std::cout.flush();
     
     sumHouseholdLoads = 0;
 
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) {
-        it->second->setLoadValues(currTime);
-        sumHouseholdLoads += it->second->activePower;
-    }
+    const double* active = getHouseholdActive();
+    for(size_t h=0; h<households.size(); h++)
+        sumHouseholdLoads += active[h];
     
     std::cout << " OK" << std::endl;
 }
 
+void GridModel::precomputeHouseholdLoads(DateTime currTime) {
+    ProfileZone zone("precompute household loads");
+    std::cout << " - Precomputing household loads ...";
+    std::cout.flush();
+    
+    // A day of intervals, but not beyond the end of the simulation
+    long remaining = (finishTime.minutesSinceEpoch() - currTime.minutesSinceEpoch())/simInterval + 1;
+    loadRows = (int)std::max(1L, std::min((long)std::max(1, 1440/simInterval), remaining));
+    loadStart = currTime;
+    
+    size_t numHouses = households.size();
+    loadActive.resize(loadRows*numHouses);
+    loadInductive.resize(loadRows*numHouses);
+    loadCapacitive.resize(loadRows*numHouses);
+    
+    // Each household fills its own column of the matrix
+    int h = 0;
+    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it, ++h)
+        it->second->generateLoadValues(currTime, simInterval, loadRows, numHouses,
+                                       &loadActive[h], &loadInductive[h], &loadCapacitive[h]);
+    
+    std::cout << " OK (" << loadRows << " intervals)" << std::endl;
+}
+
+const double* GridModel::getHouseholdActive() const {
+    return loadActive.empty() ? NULL : &loadActive[loadRow*households.size()];
+}
+
+const double* GridModel::getHouseholdInductive() const {
+    return loadInductive.empty() ? NULL : &loadInductive[loadRow*households.size()];
+}
+
+const double* GridModel::getHouseholdCapacitive() const {
+    return loadCapacitive.empty() ? NULL : &loadCapacitive[loadRow*households.size()];
+}
+
 void GridModel::resetVehicleLoads() {
     for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
         it->second->setPowerDemand(0, 0, 0);  
@@ -302,10 +384,13 @@ void GridModel::displayLoadSummary(DateTime currTime) {
                 evMax = currPower;
         }
     }
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) {
-        currPower = it->second->activePower;
+    const double* active = getHouseholdActive();
+    const double* inductive = getHouseholdInductive();
+    const double* capacitive = getHouseholdCapacitive();
+    for(size_t h=0; active != NULL && h<households.size(); h++) {
+        currPower = active[h];
         
-        hhPF += it->second->getPowerFactor(currTime);
+        hhPF += cos(atan2(inductive[h]+capacitive[h], active[h]));
         hhSum += currPower;
         if(currPower < hhMin)
             hhMin = currPower;
@@ -341,7 +426,7 @@ void GridModel::displayLoadSummary(DateTime currTime) {
 
 
 void GridModel::runValleyLoadFlow(DateTime datetime) {
-    boost::posix_time::ptime timerFull, timer;
+    ProfileZone zoneFull("valley load flow");
     
     // Choose valley time 4am on the chosen date
     DateTime valleytime = datetime;
@@ -351,103 +436,205 @@ void GridModel::runValleyLoadFlow(DateTime datetime) {
     for(std::map<std::string,Household*>::iterator it = households.begin(); it!= households.end(); ++it)
         it->second->setLoadValues(valleytime);
 
-    utility::startTimer(timerFull);
-    utility::startTimer(timer);
-    
     std::cout << "Running valley load flow analysis ... " << std::endl;
     
-    // Create temporary directory for file interaction with load flow software
-    tempDir = logDir + "temp/";
-    boost::filesystem::path tempPath(tempDir);
-    if(!boost::filesystem::exists(tempPath))
-        boost::filesystem::create_directory(tempPath);
-    
-    std::cout << " - setting household loads ...";
-    std::ofstream outfile(std::string(tempDir + "tempHHloads.txt").c_str());
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it)
-        outfile << it->second->componentName << ", "
-                << it->second->activePower+0.001 << ", "
-                << it->second->inductivePower << ", "
-                << it->second->capacitivePower << std::endl;
-    outfile.close();
-    loadflow->setDemand(std::string(tempDir + "tempHHloads.txt"));
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
-    
-    std::cout << " - setting vehicle loads to zero ...";
-    outfile.open(std::string(tempDir + "tempVHloads.txt").c_str());
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
-        outfile << it->second->componentName << ", 0.001, 0, 0" << std::endl;
-    outfile.close();
-    loadflow->setDemand(std::string(tempDir + "tempVHloads.txt"));
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
+    std::cout << " - setting household loads, vehicle loads to zero ...";
+    int n = 0;
+    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it, ++n) {
+        demandActive[n] = it->second->activePower+0.001;
+        demandInductive[n] = it->second->inductivePower;
+        demandCapacitive[n] = it->second->capacitivePower;
+    }
+    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it, ++n) {
+        demandActive[n] = 0.001;
+        demandInductive[n] = 0;
+        demandCapacitive[n] = 0;
+    }
+    {
+        ProfileZone zone("setDemand");
+        loadflow->setDemand(&demandActive[0], &demandInductive[0], &demandCapacitive[0], n);
+    }
+    std::cout << " OK" << std::endl;
     
     std::cout << " - running load flow calculation ...";
     std::cout.flush();
-    loadflow->runSim();
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
+    {
+        ProfileZone zone("runSim");
+        loadflow->runSim();
+    }
+    std::cout << " OK" << std::endl;
     
     std::cout << " - getting output ...";
-    loadflow->getOutputs(tempDir, networkData, households, lineSegments, poles);
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
+    {
+        ProfileZone zone("getOutputs");
+        loadflow->getOutputs(logDir, networkData, households, lineSegments, poles);
+    }
+    std::cout << " OK" << std::endl;
 
     for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it)
 	it->second->V_valley = it->second->V_RMS;
 
-    std::cout << "Load flow analysis complete, took: " << utility::endTimer(timerFull) << std::endl;
+    std::cout << "Load flow analysis complete" << std::endl;
 }
 
 
 void GridModel::runLoadFlow() {
-    boost::posix_time::ptime timerFull, timer;
-    
-    utility::startTimer(timerFull);
-    utility::startTimer(timer);
+    ProfileZone zoneFull("load flow");
     
     std::cout << "Running load flow analysis ... " << std::endl;
         
-    // Create temporary directory for file interaction with load flow software
-    tempDir = logDir + "temp/";
-    boost::filesystem::path tempPath(tempDir);
-    if(!boost::filesystem::exists(tempPath))
-        boost::filesystem::create_directory(tempPath);
-    
-    std::cout << " - setting household loads ...";
-    std::ofstream outfile(std::string(tempDir + "tempHHloads.txt").c_str());
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it)
-        outfile << it->second->componentName << ", "
-                << it->second->activePower+0.001 << ", "
-                << it->second->inductivePower << ", "
-                << it->second->capacitivePower << std::endl;
-    outfile.close();
-    loadflow->setDemand(std::string(tempDir + "tempHHloads.txt"));
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
-    
-    std::cout << " - setting vehicle loads ...";
-    outfile.open(std::string(tempDir + "tempVHloads.txt").c_str());
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
-        outfile << it->second->componentName << ", "
-                << it->second->activePower+0.001 << ", "
-                << it->second->inductivePower << ", "
-                << it->second->capacitivePower << std::endl;
-    outfile.close();
-    loadflow->setDemand(std::string(tempDir + "tempVHloads.txt"));
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
+    std::cout << " - setting household and vehicle loads ...";
+    const double* active = getHouseholdActive();
+    const double* inductive = getHouseholdInductive();
+    const double* capacitive = getHouseholdCapacitive();
+    if(active == NULL) {
+        std::cout << "ERROR: household loads must be generated before running load flow" << std::endl;
+        exit(1);
+    }
+    int n = 0;
+    for(; n < (int)households.size(); ++n) {
+        demandActive[n] = active[n]+0.001;
+        demandInductive[n] = inductive[n];
+        demandCapacitive[n] = capacitive[n];
+    }
+    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it, ++n) {
+        demandActive[n] = it->second->activePower+0.001;
+        demandInductive[n] = it->second->inductivePower;
+        demandCapacitive[n] = it->second->capacitivePower;
+    }
+    
+    // If a result for (nearly) the same loads has been cached, use it
+    if(loadFlowCache != NULL && loadFlowCache->lookup(demandActive, demandInductive, demandCapacitive,
+                                                      networkData, households, lineSegments, poles)) {
+        lastLoadFlowCached = true;
+        std::cout << " OK, found in cache" << std::endl;
+        std::cout << "Load flow analysis complete" << std::endl;
+        return;
+    }
+    lastLoadFlowCached = false;
+    
+    {
+        ProfileZone zone("setDemand");
+        loadflow->setDemand(&demandActive[0], &demandInductive[0], &demandCapacitive[0], n);
+    }
+    std::cout << " OK" << std::endl;
     
     std::cout << " - running load flow calculation ...";
     std::cout.flush();
-    loadflow->runSim();
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
+    {
+        ProfileZone zone("runSim");
+        loadflow->runSim();
+    }
+    std::cout << " OK" << std::endl;
     
     std::cout << " - getting output ...";
     std::cout.flush();
-    loadflow->getOutputs(tempDir, networkData, households, lineSegments, poles);
-    std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
+    {
+        ProfileZone zone("getOutputs");
+        loadflow->getOutputs(logDir, networkData, households, lineSegments, poles);
+    }
+    std::cout << " OK" << std::endl;
+    if(networkData.iterations > 0)
+        std::cout << " - load flow converged in " << networkData.iterations << " iteration(s)" << std::endl;
+    
+    if(loadFlowCache != NULL)
+        loadFlowCache->store(networkData, households, lineSegments, poles);
 
     //std::cout << " - calculating voltage unbalance ..." << std::endl;
     //calculateVoltageUnbalance(currTime);
     //std::cout << " OK (took " << utility::updateTimer(timer) << ")" << std::endl;
 
-    std::cout << "Load flow analysis complete, took: " << utility::endTimer(timerFull) << std::endl;
+    std::cout << "Load flow analysis complete" << std::endl;
+}
+
+
+void GridModel::runIncrementalLoadFlow(std::vector<int> vehicleNMIs) {
+    // A cached result leaves no solution in the load flow interface to update
+    if(!incrementalLoadFlow || lastLoadFlowCached) {
+        runLoadFlow();
+        return;
+    }
+    
+    ProfileZone zoneFull("incremental load flow");
+    
+    std::cout << "Running incremental load flow analysis ... " << std::endl;
+    
+    std::cout << " - setting loads of " << vehicleNMIs.size() << " vehicle(s) ...";
+    std::vector<int> changedLoads;
+    Vehicle* vehicle;
+    int n;
+    for(int i=0; i<vehicleNMIs.size(); i++) {
+        vehicle = findVehicle(vehicleNMIs.at(i));
+        n = vehicleDemandIndex[vehicle->NMI];
+        demandActive[n] = vehicle->activePower+0.001;
+        demandInductive[n] = vehicle->inductivePower;
+        demandCapacitive[n] = vehicle->capacitivePower;
+        changedLoads.push_back(n);
+    }
+    {
+        ProfileZone zone("setDemand");
+        loadflow->setDemand(&demandActive[0], &demandInductive[0], &demandCapacitive[0], demandActive.size());
+    }
+    std::cout << " OK" << std::endl;
+    
+    std::cout << " - updating load flow solution ...";
+    std::cout.flush();
+    {
+        ProfileZone zone("runIncrementalSim");
+        if(!loadflow->runIncrementalSim(changedLoads)) {
+            std::cout << " not supported, running full calculation ...";
+            std::cout.flush();
+            loadflow->runSim();
+        }
+    }
+    std::cout << " OK" << std::endl;
+    
+    std::cout << " - getting output ...";
+    std::cout.flush();
+    {
+        ProfileZone zone("getOutputs");
+        loadflow->getOutputs(logDir, networkData, households, lineSegments, poles);
+    }
+    std::cout << " OK" << std::endl;
+
+    std::cout << "Load flow analysis complete" << std::endl;
+}
+
+
+void GridModel::runBatchLoadFlow(int numScenarios, 
+                                 std::vector<double> &active, 
+                                 std::vector<double> &inductive, 
+                                 std::vector<double> &capacitive,
+                                 std::vector<double> &householdV) {
+    ProfileZone zone("batch load flow");
+    
+    int numLoads = demandActive.size();
+    int numHouses = households.size();
+    householdV.assign(numScenarios*numHouses, 0);
+    
+    std::cout << "Running batch load flow analysis for " << numScenarios << " scenarios ...";
+    std::cout.flush();
+    if(!loadflow->runBatchSim(numScenarios, &active[0], &inductive[0], &capacitive[0], &householdV[0])) {
+        std::cout << " not supported, solving one at a time ...";
+        std::cout.flush();
+        for(int s=0; s<numScenarios; s++) {
+            loadflow->setDemand(&active[s*numLoads], &inductive[s*numLoads], &capacitive[s*numLoads], numLoads);
+            loadflow->runSim();
+            loadflow->getOutputs(logDir, networkData, households, lineSegments, poles);
+            
+            int h = 0;
+            for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it, ++h)
+                householdV[s*numHouses+h] = it->second->V_RMS;
+        }
+        
+        // Solving one at a time left the last scenario's loads and outputs in
+        // place, so solve this interval's own loads again to restore them
+        loadflow->setDemand(&demandActive[0], &demandInductive[0], &demandCapacitive[0], numLoads);
+        loadflow->runSim();
+        loadflow->getOutputs(logDir, networkData, households, lineSegments, poles);
+        lastLoadFlowCached = false;
+    }
+    std::cout << " OK" << std::endl;
 }
 
 
@@ -468,15 +655,15 @@ double GridModel::getSumHouseholdLoads() {
     return sumHouseholdLoads;
 }
 
-double GridModel::getDeviation(DateTime currTime) {
+double GridModel::getDeviation(DateTime currTime) const {
     double totalPhaseI[3];
     
     // add total current on each phase due to household demand
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) 
+    for(std::map<std::string,Household*>::const_iterator it = households.begin(); it != households.end(); ++it) 
         totalPhaseI[(int)(it->second->phase)] += it->second->getDemandAt(currTime).P/baseVoltage;
     
     // add total current on each phase due to vehicle demand
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
+    for(std::map<std::string,Vehicle*>::const_iterator it = vehicles.begin(); it != vehicles.end(); ++it)
         totalPhaseI[(int)(findHousehold(it->second->NMI)->phase)] += it->second->chargeRate / baseVoltage;
     
     // calculate average
@@ -494,12 +681,14 @@ double GridModel::getDeviation(DateTime currTime) {
     return percentDev;
 }
 
-Household* GridModel::findHousehold(int NMI) {
-    return householdNMImap[NMI];
+Household* GridModel::findHousehold(int NMI) const {
+    std::map<int,Household*>::const_iterator it = householdNMImap.find(NMI);
+    return (it == householdNMImap.end()) ? NULL : it->second;
 }
 
-Vehicle* GridModel::findVehicle(int NMI) {
-    return vehicleNMImap[NMI];
+Vehicle* GridModel::findVehicle(int NMI) const {
+    std::map<int,Vehicle*>::const_iterator it = vehicleNMImap.find(NMI);
+    return (it == vehicleNMImap.end()) ? NULL : it->second;
 }
 
 // recalculate individual phase voltages at each pole
@@ -509,116 +698,184 @@ void GridModel::calculateVoltageUnbalance(DateTime currTime) {
     current[1].set(0,-120);
     current[2].set(0,120);
     
-    calculatePoleCurrents(root, current, currTime);
+    calculatePoleCurrents(current, currTime);
     std::cout << "At root, currents are: " << std::endl;
     for(int i=0; i<3; i++)
         std::cout << " " << i+1 << ": " << current[i].toString() << "\n";
     
-    calculatePoleVoltages(root);
+    calculatePoleVoltages();
     std::cout << "At root, voltages are: " << std::endl;
     for(int i=0; i<3; i++)
         std::cout << " " << i+1 << ": " << root->voltage[i].toString() << "\n";
     
 }
 
-// Calculate current at each pole
-void GridModel::calculatePoleCurrents(FeederPole* pole, Phasor I[], DateTime currTime) {
-    // Recursively iterate through to leaves
-    if(pole->childLineSegments.size() > 0)
-        for(std::vector<FeederLineSegment*>::iterator it=pole->childLineSegments.begin(); it!=pole->childLineSegments.end(); ++it)
-            if((*it)->childPole != NULL)
-                calculatePoleCurrents((*it)->childPole, I, currTime);
+// Calculate current at each pole:  backward pass over compiled network,
+// accumulating household (and vehicle) currents from leaves to root
+void GridModel::calculatePoleCurrents(Phasor I[], DateTime currTime) {
+    std::vector< std::complex<double> > poleI(3*network.numPoles, std::complex<double>(0,0));
+    std::complex<double> currI;
+    double P;
+    int phase;
+    
+    network.updateLoads(getHouseholdActive(), getHouseholdInductive(), getHouseholdCapacitive());
+    for(int h=0; h<network.numHouses; h++) {
+        phase = network.housePhase[h];
+        if(phase < 0 || phase > 2)
+            continue;
+        P = network.houseP[h];
+        if(network.houses[h]->hasCar)
+            P += findVehicle(network.houses[h]->NMI)->chargeRate;
+        currI = std::complex<double>(P / baseVoltage, network.houseQ[h] / baseVoltage) 
+                * std::polar(1.0, 2*M_PI*phase/3);
+        poleI[3*network.housePole[h] + phase] += currI;
+    }
+    for(int i=network.numPoles-1; i>0; i--)
+        for(int p=0; p<3; p++)
+            poleI[3*network.parent[i] + p] += poleI[3*i + p];
     
-    // Add current from each house and vehicle
-    Household* currHouse;
-    int currPhase;
-    Phasor currI;
+    for(int i=0; i<network.numPoles; i++)
+        for(int p=0; p<3; p++)
+            network.poles[i]->current[p].setRC(poleI[3*i+p].real(), poleI[3*i+p].imag());
     
-    if(pole->households.size() > 0)
-        for(std::vector<Household*>::iterator it=pole->households.begin(); it!=pole->households.end(); ++it) {
-
-            currHouse = *it;
-            currPhase = (int)(currHouse->phase);
-            currI.setRC(currHouse->getDemandAt(currTime).P / baseVoltage, currHouse->getDemandAt(currTime).Q / baseVoltage);
-            if(currHouse->hasCar)
-                currI.addReal(findVehicle(currHouse->NMI)->chargeRate / baseVoltage);
-            if(currPhase == 1)
-                currI.addPhase(120);
-            else if(currPhase == 2)
-                currI.addPhase(240);
-
-            I[currPhase] = I[currPhase].plus(currI);
-        }
-    
-    for(int i=0; i<3; i++)
-        pole->current[i] = I[i];
+    for(int p=0; p<3; p++)
+        I[p] = I[p].plus(network.poles[0]->current[p]);
 }
 
-// Calculate current at each pole
-void GridModel::calculatePoleVoltages(FeederPole* pole) {
+// Calculate voltage at each pole:  single pass over compiled network
+void GridModel::calculatePoleVoltages() {
     Phasor txVoltage[3];
     txVoltage[0].set(transformer->voltageOut*sqrt(2.0), 0);
     txVoltage[1].set(transformer->voltageOut*sqrt(2.0), -120);
     txVoltage[2].set(transformer->voltageOut*sqrt(2.0), 120);
     
-    std::cout << pole->name << ":";
-    for(int i=0; i<3; i++) {
-        pole->voltage[i] = txVoltage[i].minus(pole->current[i].times(pole->totalImpedanceToTX));
-        std::cout << "\n  " << i << "        I: " << pole->current[i].toString() 
-                  << "\n           Z: " << pole->totalImpedanceToTX.toString()
-                  << "\n           V: " << pole->voltage[i].toString() << std::endl;
+    FeederPole* pole;
+    for(int i=0; i<network.numPoles; i++) {
+        pole = network.poles[i];
+        for(int p=0; p<3; p++)
+            pole->voltage[p] = txVoltage[p].minus(pole->current[p].times(pole->totalImpedanceToTX));
     }
+}
+
+// Single forward pass over compiled network, keeping track of impedance for 
+// each pole and house
+void GridModel::calculateHouseholdZ() {
+    std::vector<double> r(network.numPoles, 0);
+    std::vector<double> x(network.numPoles, 0);
     
-    Phasor a, a2;
-    a.set(1,120);
-    a2.set(1,240);
-    
-    Phasor vAB = pole->voltage[1].minus(pole->voltage[0]);
-    Phasor vBC = pole->voltage[2].minus(pole->voltage[1]);
-    Phasor vCA = pole->voltage[0].minus(pole->voltage[2]);
-    
-    Phasor vMinus = vAB.plus(vBC.times(a2).plus(vCA.times(a)));
-    Phasor vPlus = vAB.plus(vBC.times(a).plus(vCA.times(a2)));
+    for(int i=0; i<network.numPoles; i++) {
+        if(network.parent[i] >= 0) {
+            r[i] = r[network.parent[i]] + network.segmentR[i];
+            x[i] = x[network.parent[i]] + network.segmentL[i] - network.segmentC[i];
+        }
+        network.poles[i]->totalImpedanceToTX.resistance = r[i];
+        network.poles[i]->totalImpedanceToTX.reactance = x[i];
+    }
     
-    std::cout << "\n------------------------"
-              << "\n         Vab: " << vAB.toString()
-              << "\n         Vbc: " << vBC.toString()
-              << "\n         Vca: " << vCA.toString()
-              << "\n       Vca*a: " << vCA.times(a).toString()
-              << "\n      Vbc*a2: " << vBC.times(a2).toString()
-              << "\nVbc*a2+Vca*a: " << (vBC.times(a2).plus(vCA.times(a))).toString()
-              << "\n          V-: " << vMinus.toString()
-              << "\n          V+: " << vPlus.toString()
-              << "\n       V-/V+: " << vMinus.dividedBy(vPlus).toString()
-              << "\n           %: " << vMinus.getAmplitude() / vPlus.getAmplitude() * 100
-              << "\n________________________________________________________\n"
-              << std::endl;
-              
-
-    for(std::vector<FeederLineSegment*>::iterator it=pole->childLineSegments.begin(); it!=pole->childLineSegments.end(); ++it)
-        if((*it)->childPole != NULL)
-            calculatePoleVoltages((*it)->childPole);
+    // Households add active and neutral service line
+    int pole;
+    for(int h=0; h<network.numHouses; h++) {
+        pole = network.housePole[h];
+        network.houses[h]->totalImpedanceToTX.resistance = r[pole] + 2*network.serviceR[h];
+        network.houses[h]->totalImpedanceToTX.reactance = x[pole] + 2*(network.serviceL[h] - network.serviceC[h]);
+    }
 }
 
-// Recursive DFS traversal of network tree, keeping track of impedance for each house
-void GridModel::calculateHouseholdZ(FeederPole* pole, double r, double x) {
-    pole->totalImpedanceToTX.resistance = r;
-    pole->totalImpedanceToTX.reactance = x;
+// Linearised sensitivity of household voltage magnitudes to household loads.
+// A change in current dI_j at house j causes a voltage change -Z*dI_j at 
+// house i across the path impedance Z they share:  in both phase and neutral 
+// conductor if on the same phase, in neutral only otherwise.  Projecting onto
+// house i's voltage phasor gives the change in magnitude.
+void GridModel::calculateSensitivities() {
+    int numHouses = network.numHouses;
+    int numPoles = network.numPoles;
+    double omega = 2*M_PI*frequency;
+    
+    std::cout << " - calculating voltage sensitivities ...";
+    std::cout.flush();
     
-    // First, update all households connected to this pole (Note: ignore service line impedance)
-    for(std::vector<Household*>::iterator it=pole->households.begin(); it!=pole->households.end(); ++it) {
-        (*it)->totalImpedanceToTX.resistance = r + 2* (*it)->serviceLine.length * (*it)->serviceLine.resistance;
-        (*it)->totalImpedanceToTX.reactance = x + 2* (*it)->serviceLine.length * ((*it)->serviceLine.inductance - (*it)->serviceLine.capacitance);
+    // Impedance from transformer to each pole
+    std::vector< std::complex<double> > Zcum(numPoles, std::complex<double>(0,0));
+    for(int i=1; i<numPoles; i++)
+        Zcum[i] = Zcum[network.parent[i]] + std::complex<double>(network.segmentR[i], omega*network.segmentL[i]);
+    
+    // Households at each pole
+    std::vector< std::vector<int> > poleHouses(numPoles);
+    for(int h=0; h<numHouses; h++)
+        poleHouses[network.housePole[h]].push_back(h);
+    
+    // Operating point
+    std::vector<double> Vmag(numHouses), Vang(numHouses);
+    for(int h=0; h<numHouses; h++) {
+        Vmag[h] = network.houses[h]->V_RMS;
+        Vang[h] = network.houses[h]->V_Pha * M_PI/180;
     }
     
-    double tempR, tempX;
-    // Second, for every child pole of this pole, do the same
-    for(std::vector<FeederLineSegment*>::iterator it=pole->childLineSegments.begin(); it!=pole->childLineSegments.end(); ++it) {
-        tempR = r + (*it)->line.length * (*it)->line.resistance;
-        tempX = x + (*it)->line.length * ((*it)->line.inductance - (*it)->line.capacitance);
-        if((*it)->childPole != NULL)
-            calculateHouseholdZ((*it)->childPole, tempR, tempX);
+    sensitivityP.assign(numHouses*numHouses, 0);
+    sensitivityQ.assign(numHouses*numHouses, 0);
+    sensitivityV.assign(numHouses, 0);
+    for(int h=0; h<numHouses; h++)
+        sensitivityV[h] = network.houses[h]->V_RMS;
+    
+    // For each pole a, the deepest ancestor of every pole b that is shared 
+    // with a (lowest common ancestor)
+    std::vector<int> marked(numPoles, -1), common(numPoles, 0);
+    std::complex<double> Zc, rot;
+    double factor;
+    int i, j;
+    for(int a=0; a<numPoles; a++) {
+        if(poleHouses[a].empty())
+            continue;
+        for(int p=a; p>=0; p=network.parent[p])
+            marked[p] = a;
+        for(int b=0; b<numPoles; b++)
+            common[b] = (marked[b] == a) ? b : common[network.parent[b]];
+        
+        for(int jj=0; jj<poleHouses[a].size(); jj++) {
+            j = poleHouses[a][jj];
+            for(i=0; i<numHouses; i++) {
+                Zc = Zcum[common[network.housePole[i]]];
+                if(i == j)
+                    Zc += std::complex<double>(network.serviceR[j], omega*network.serviceL[j]);
+                factor = (network.housePhase[i] == network.housePhase[j]) ? 2.0 : 1.0;
+                
+                // Loads are constant impedance, specified at base voltage:
+                // dI_j = (dP - j dQ) * |V_j| / Vbase^2, at angle of V_j
+                rot = Zc * std::polar(1.0, Vang[j] - Vang[i]);
+                sensitivityP[j*numHouses + i] = -factor * rot.real() * Vmag[j] / (baseVoltage*baseVoltage);
+                sensitivityQ[j*numHouses + i] = -factor * rot.imag() * Vmag[j] / (baseVoltage*baseVoltage);
+            }
+        }
     }
+    
+    std::cout << " OK" << std::endl;
+}
+
+std::vector<double> GridModel::estimateVoltages(std::vector<double> &deltaP, std::vector<double> &deltaQ) {
+    int numHouses = network.numHouses;
+    
+    // Refresh sensitivities if operating point has drifted
+    bool refresh = (sensitivityV.size() != numHouses);
+    for(int h=0; h<numHouses && !refresh; h++)
+        if(std::fabs(network.houses[h]->V_RMS - sensitivityV[h]) > sensitivityDrift)
+            refresh = true;
+    if(refresh)
+        calculateSensitivities();
+    
+    std::vector<double> V(numHouses);
+    for(int h=0; h<numHouses; h++)
+        V[h] = network.houses[h]->V_RMS;
+    
+    double *colP, *colQ;
+    for(int j=0; j<numHouses; j++) {
+        if(deltaP[j] == 0 && deltaQ[j] == 0)
+            continue;
+        colP = &sensitivityP[j*numHouses];
+        colQ = &sensitivityQ[j*numHouses];
+        for(int i=0; i<numHouses; i++)
+            V[i] += colP[i]*deltaP[j] + colQ[i]*deltaQ[j];
+    }
+    return V;
 }
 
 // Create mapping from households to NMIs (not names)
@@ -635,6 +892,73 @@ void GridModel::buildVehicleNMImap() {
         vehicleNMImap[it->second->NMI] = it->second;
 }
 
+void GridModel::registerDemandComponents() {
+    std::vector<std::string> components;
+    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it)
+        components.push_back(it->second->componentName);
+    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
+        components.push_back(it->second->componentName);
+    
+    loadflow->setDemandComponents(components);
+    
+    vehicleDemandIndex.clear();
+    int n = households.size();
+    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it, ++n)
+        vehicleDemandIndex[it->second->NMI] = n;
+    demandActive.assign(components.size(), 0);
+    demandInductive.assign(components.size(), 0);
+    demandCapacitive.assign(components.size(), 0);
+}
+
 void GridModel::setLogDir(std::string path) {
     logDir = path;
-}
\ No newline at end of file
+}
+
+void GridModel::saveState(std::ostream &out) {
+    random.saveState(out);
+    
+    utility::writeBinary(out, (int)households.size());
+    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) {
+        utility::writeBinary(out, it->second->NMI);
+        it->second->saveState(out);
+    }
+    
+    utility::writeBinary(out, (int)vehicles.size());
+    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it) {
+        utility::writeBinary(out, it->second->NMI);
+        it->second->saveState(out);
+    }
+}
+
+void GridModel::loadState(std::istream &in) {
+    int num, nmi;
+    random.loadState(in);
+    
+    utility::readBinary(in, num);
+    if(num != households.size()) {
+        std::cout << "Error: checkpoint has " << num << " households, model has " << households.size() << std::endl;
+        exit(1);
+    }
+    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) {
+        utility::readBinary(in, nmi);
+        if(nmi != it->second->NMI) {
+            std::cout << "Error: checkpoint does not match households of model (NMI " << nmi << ")" << std::endl;
+            exit(1);
+        }
+        it->second->loadState(in);
+    }
+    
+    utility::readBinary(in, num);
+    if(num != vehicles.size()) {
+        std::cout << "Error: checkpoint has " << num << " vehicles, model has " << vehicles.size() << std::endl;
+        exit(1);
+    }
+    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it) {
+        utility::readBinary(in, nmi);
+        if(nmi != it->second->NMI) {
+            std::cout << "Error: checkpoint does not match vehicles of model (NMI " << nmi << ")" << std::endl;
+            exit(1);
+        }
+        it->second->loadState(in);
+    }
+}
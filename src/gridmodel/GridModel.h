@@ -40,6 +40,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <map>
 #include <cmath>
+#include <complex>
 #include <iomanip>
 #include <string.h>
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -48,11 +49,14 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "../loadflow/LoadFlowInterface.h"
 #include "../loadflow/MatlabInterface.h"
 #include "../utility/Utility.h"
+#include "../utility/Profiler.h"
 #include "../household/HouseholdDemandModel.h"
 #include "../household/Household.h"
 #include "../vehicle/Vehicle.h"
 #include "DistributionTransformer.h"
 #include "NetworkData.h"
+#include "CompiledNetwork.h"
+#include "../loadflow/LoadFlowCache.h"
 
 
 /** The full grid model.  This class contains all houses, vehicles, and any
@@ -86,8 +90,80 @@ private:
     /** Directory for logging data */
     std::string logDir;
     
-    /** Directory for temporary data storage / file interaction with load flow software */
-    std::string tempDir;
+    /** Active power of all loads as passed to the load flow interface:
+      * households first (in the order of the households map), followed by
+      * vehicles (in the order of the vehicles map). */
+    std::vector<double> demandActive;
+    
+    /** Inductive power of all loads, same order as demandActive. */
+    std::vector<double> demandInductive;
+    
+    /** Capacitive power of all loads, same order as demandActive. */
+    std::vector<double> demandCapacitive;
+    
+    /** Position of each vehicle's load in the demand arrays, mapped to the 
+      * vehicle's NMI. */
+    std::map<int, int> vehicleDemandIndex;
+    
+    /** True if load flow may be updated incrementally when only a few
+      * vehicle loads change (local copy of config variable). */
+    bool incrementalLoadFlow;
+    
+    /** Master seed of simulation, from which all random streams are derived. */
+    unsigned int randomSeed;
+    
+    /** Random stream of grid model (e.g. for vehicle placement). */
+    RandomStream random;
+    
+    /** Network frequency (local copy of config variable). */
+    double frequency;
+    
+    /** Sensitivity of household voltages to household active power, one
+      * column per household whose load changes:  element [j*numHouses + i]
+      * is dV_i/dP_j (V/W).  Households in order of their names. */
+    std::vector<double> sensitivityP;
+    
+    /** Sensitivity of household voltages to household reactive power, 
+      * same layout as sensitivityP (V/VAr). */
+    std::vector<double> sensitivityQ;
+    
+    /** Household voltages (RMS) at the operating point the sensitivities 
+      * were last calculated for. */
+    std::vector<double> sensitivityV;
+    
+    /** Sensitivities are recalculated once any household voltage has moved
+      * more than this (V) from the operating point they were calculated at. */
+    double sensitivityDrift;
+    
+    /** True if the last load flow result was taken from the cache, in which
+      * case the load flow interface holds no solution for the current loads. */
+    bool lastLoadFlowCached;
+    
+    /** Simulation interval in minutes (local copy of config variable). */
+    int simInterval;
+    
+    /** Last interval of the simulation; household loads are not generated
+      * beyond it. */
+    DateTime finishTime;
+    
+    /** Household loads precomputed for up to a day of intervals, one row of
+      * active power per interval with households in the order of their map. */
+    std::vector<double> loadActive;
+    
+    /** Precomputed inductive household loads, same layout as loadActive. */
+    std::vector<double> loadInductive;
+    
+    /** Precomputed capacitive household loads, same layout as loadActive. */
+    std::vector<double> loadCapacitive;
+    
+    /** Time of first row of precomputed household loads. */
+    DateTime loadStart;
+    
+    /** Number of rows of precomputed household loads. */
+    int loadRows;
+    
+    /** Row of precomputed household loads for the current interval. */
+    int loadRow;
     
 
 public:
@@ -119,6 +195,12 @@ public:
     /** All relevant network data */
     NetworkData networkData;
     
+    /** Flattened view of network tree, for fast traversal. */
+    CompiledNetwork network;
+    
+    /** Cache of load flow results, NULL if disabled. */
+    LoadFlowCache* loadFlowCache;
+    
     
     
 public:
@@ -128,17 +210,36 @@ public:
     /** Destructor */
     virtual ~GridModel();
     
-    /** Initialise, load grid model, add vehicles and other components as required. */
-    void initialise(Config* config, LoadFlowInterface* loadflow);
+    /** Initialise, load grid model, add vehicles and other components as required.
+      * Random streams of all households and vehicles are derived from seed. */
+    void initialise(Config* config, LoadFlowInterface* loadflow, unsigned int seed);
     
     /** Assumes traffic model and charging algorithm have been run, charges
       * or discharges vehicles' batteries as required. */
     void updateVehicleBatteries();
     
     /** Using households' demand profiles, generates demand for each house for
-      * next interval. */
+      * next interval.  Loads are taken from the precomputed rows, which are
+      * regenerated a day at a time once currTime has moved past them. */
     void generateAllHouseholdLoads(DateTime currTime);
     
+    /** Precompute household loads for a day of intervals (or until the end of
+      * the simulation) starting at currTime.  Household loads do not depend on
+      * vehicle loads, so they can be generated ahead of the simulation. */
+    void precomputeHouseholdLoads(DateTime currTime);
+    
+    /** Active power of all households in the current interval, in the order
+      * of the households map.  These rows are the only record of interval 
+      * loads (household members are only set by setLoadValues, e.g. for the
+      * valley load flow).  NULL until generateAllHouseholdLoads is called. */
+    const double* getHouseholdActive() const;
+    
+    /** Inductive power of all households in the current interval. */
+    const double* getHouseholdInductive() const;
+    
+    /** Capacitive power of all households in the current interval. */
+    const double* getHouseholdCapacitive() const;
+    
     /** Reset all vehicle loads. */
     void resetVehicleLoads();
     
@@ -165,6 +266,33 @@ public:
     /** Run full load flow using specified load flow interface. */
     void runLoadFlow();
     
+    /** Run load flow following a change in the loads of the given vehicles
+      * only (e.g. individual or grouped charge rate updates).  If enabled and
+      * supported by the load flow interface, only the effect of these changes
+      * is applied to the previous solution, otherwise a full load flow is run. */
+    void runIncrementalLoadFlow(std::vector<int> vehicleNMIs);
+    
+    /** Run load flow for several load scenarios at once (e.g. Monte Carlo
+      * realisations of household and vehicle loads).  Loads are given as
+      * numScenarios x (households + vehicles) matrices, one row per scenario,
+      * with households and vehicles in the order of their maps.  Returns RMS
+      * voltage of every household as a numScenarios x households matrix. 
+      * Interfaces that cannot solve scenarios in batch solve them one by one,
+      * after which the loads of the last load flow are solved again, so
+      * that outputs and household voltages are those of the interval. */
+    void runBatchLoadFlow(int numScenarios, 
+                          std::vector<double> &active, 
+                          std::vector<double> &inductive, 
+                          std::vector<double> &capacitive,
+                          std::vector<double> &householdV);
+    
+    /** Estimate RMS voltage at each household (in order of their names),
+      * following the given changes in each household's active and reactive 
+      * power (including any vehicle there) relative to the last load flow.  
+      * Uses linearised voltage sensitivities around the last load flow 
+      * solution; only households with non-zero changes add to the cost. */
+    std::vector<double> estimateVoltages(std::vector<double> &deltaP, std::vector<double> &deltaQ);
+    
     /** Return available distribution transformer capacity after household
       * loads are accounted for (required for EqualShare charging algorithm) */
     double getAvailableCapacity();
@@ -177,19 +305,26 @@ public:
 
     
     /** Determine maximum percentage deviation of any individual phase load from average phase load */
-    double getDeviation(DateTime currTime);
+    double getDeviation(DateTime currTime) const;
     
     /** Find the household with the given NMI */
-    Household* findHousehold(int NMI);
+    Household* findHousehold(int NMI) const;
     
     /** Find the household with the given NMI */
-    Vehicle* findVehicle(int NMI);
+    Vehicle* findVehicle(int NMI) const;
     
     /** Add vehicles to the grid model as required. */
     void addVehicles(Config* config);
     
     /** Set logging directory. */
     void setLogDir(std::string logDir);
+    
+    /** Write state of all households and vehicles to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read state of all households and vehicles from checkpoint.  Exits if
+      * the checkpoint was written for a different network or vehicles. */
+    void loadState(std::istream &in);
 
 private:
     /** Load the full grid model from loadflow interface / file. */
@@ -198,18 +333,23 @@ private:
     /** Set for each household what the demand model (e.g. generic, phase-specific, etc.) is.*/
     void setHouseholdDemandModel(std::string model);
     
-    /** Calculate the total impedance at each household (using DFS traversal of tree)*/
-    void calculateHouseholdZ(FeederPole* pole, double r, double x);
+    /** Calculate the total impedance at each household (single pass over compiled network)*/
+    void calculateHouseholdZ();
     
     /** Following a load flow calculation, calculate voltage unbalance at each
       * pole in the network. */
     void calculateVoltageUnbalance(DateTime currTime);
     
-    /** DFS traversal of network tree, recalculating current at each pole. */
-    void calculatePoleCurrents(FeederPole* pole, Phasor I[], DateTime currTime);
+    /** Backward pass over compiled network, recalculating current at each
+      * pole.  Current at root is added to I. */
+    void calculatePoleCurrents(Phasor I[], DateTime currTime);
+    
+    /** Forward pass over compiled network, recalculating voltages at each pole. */
+    void calculatePoleVoltages();
     
-    /** DFS traversal of network tree, recalculating voltages at each pole. */
-    void calculatePoleVoltages(FeederPole* pole);
+    /** Recalculate voltage sensitivities around the last load flow solution,
+      * from the impedance of the path each pair of households shares. */
+    void calculateSensitivities();
     
     /** Houses are initially mapped to their names.  It can be convenient to
       * have a mapping to their NMI as well.  This function creates that mapping. */
@@ -218,6 +358,17 @@ private:
     /** Vehicles are initially mapped to their names.  It can be convenient to
       * have a mapping to their NMI as well.  This function creates that mapping. */
     void buildVehicleNMImap();
+    
+    /** Pass names of all household and vehicle components to the load flow
+      * interface, in the order their loads will later be set, and size the 
+      * demand arrays accordingly. */
+    void registerDemandComponents();
+    
+    /** Not copyable:  households, vehicles and network are owned through
+      * pointers, and the temporary directory is removed on destruction.
+      * Pass by reference instead. */
+    GridModel(const GridModel&);
+    GridModel& operator=(const GridModel&);
 };
 
 #endif	/* GRIDMODEL_H */
@@ -50,6 +50,10 @@ struct NetworkData {
     
     /** Voltage at all individual households, mapped to households' ID (NMI)*/
     std::map<int,double> householdV;
+    
+    /** Number of iterations the last load flow calculation took to converge
+      * (0 if the load flow software does not report it). */
+    int iterations;
 };
 
 #endif	/* NETWORKDATA_H */
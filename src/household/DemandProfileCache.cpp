@@ -0,0 +1,169 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "DemandProfileCache.h"
+
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/device/array.hpp>
+
+static const char DEMANDCACHE_ID[8] = {'P','O','S','S','I','M','D','P'};
+static const int DEMANDCACHE_VERSION = 2;
+
+// Slot data starts at a multiple of this (bytes) from the start of file
+static const long DEMANDCACHE_ALIGNMENT = 16;
+
+
+void DemandProfileCache::writeSources(std::ostream &out, std::vector<std::string> sourceFiles, bool timeOfDay) {
+    out.write(DEMANDCACHE_ID, sizeof(DEMANDCACHE_ID));
+    utility::writeBinary(out, DEMANDCACHE_VERSION);
+    utility::writeBinary(out, (int)timeOfDay);
+    
+    std::sort(sourceFiles.begin(), sourceFiles.end());
+    utility::writeBinary(out, (int)sourceFiles.size());
+    for(int i=0; i<sourceFiles.size(); i++) {
+        boost::filesystem::path path(sourceFiles.at(i));
+        utility::writeBinary(out, path.filename().string());
+        utility::writeBinary(out, (long)boost::filesystem::file_size(path));
+        utility::writeBinary(out, (long)boost::filesystem::last_write_time(path));
+    }
+}
+
+bool DemandProfileCache::read(std::string cacheFile, 
+                              std::vector<std::string> sourceFiles, 
+                              bool timeOfDay,
+                              std::map<std::string, HouseholdDemandProfilePtr> &profiles) {
+    if(!boost::filesystem::exists(cacheFile))
+        return false;
+    
+    boost::shared_ptr<boost::iostreams::mapped_file_source> mapping;
+    try {
+        mapping.reset(new boost::iostreams::mapped_file_source(cacheFile));
+    }
+    catch(std::exception &e) {
+        return false;
+    }
+    
+    // Header must match that of a cache compiled from the current sources
+    std::ostringstream expected;
+    writeSources(expected, sourceFiles, timeOfDay);
+    std::string sources = expected.str();
+    if(mapping->size() < sources.size() || !std::equal(sources.begin(), sources.end(), mapping->data()))
+        return false;
+    
+    // Time grid of each profile
+    boost::iostreams::stream<boost::iostreams::array_source> in(mapping->data(), mapping->size());
+    in.seekg(sources.size());
+    int numProfiles = 0;
+    utility::readBinary(in, numProfiles);
+    
+    std::vector<HouseholdDemandProfile*> newProfiles;
+    std::vector<long> offsets;
+    long totalSlots = 0;
+    for(int i=0; i<numProfiles && in; i++) {
+        HouseholdDemandProfile* profile = new HouseholdDemandProfile();
+        long numSlots = 0;
+        utility::readBinary(in, profile->name);
+        utility::readBinary(in, profile->firstMinute);
+        utility::readBinary(in, profile->resolution);
+        utility::readBinary(in, numSlots);
+        if(profile->resolution == 0 && numSlots > 0 && numSlots <= (long)mapping->size()) {
+            profile->slotMinutes.resize(numSlots);
+            for(long j=0; j<numSlots; j++)
+                utility::readBinary(in, profile->slotMinutes[j]);
+        }
+        profile->timeOfDay = timeOfDay;
+        profile->numSlots = numSlots;
+        profile->mappedFile = mapping;
+        newProfiles.push_back(profile);
+        offsets.push_back(totalSlots);
+        totalSlots += numSlots;
+    }
+    
+    // Slot data follows header, aligned
+    long dataStart = ((long)in.tellg() + DEMANDCACHE_ALIGNMENT-1) / DEMANDCACHE_ALIGNMENT * DEMANDCACHE_ALIGNMENT;
+    if(!in || dataStart + totalSlots*(long)sizeof(S_Load) > (long)mapping->size()) {
+        for(int i=0; i<newProfiles.size(); i++)
+            delete newProfiles.at(i);
+        return false;
+    }
+    
+    const S_Load* data = reinterpret_cast<const S_Load*>(mapping->data() + dataStart);
+    for(int i=0; i<newProfiles.size(); i++) {
+        newProfiles.at(i)->slots = data + offsets.at(i);
+        profiles[newProfiles.at(i)->name] = HouseholdDemandProfilePtr(newProfiles.at(i));
+    }
+    return true;
+}
+
+bool DemandProfileCache::write(std::string cacheFile, 
+                               std::vector<std::string> sourceFiles, 
+                               bool timeOfDay,
+                               std::map<std::string, HouseholdDemandProfilePtr> &profiles) {
+    std::ostringstream header;
+    writeSources(header, sourceFiles, timeOfDay);
+    utility::writeBinary(header, (int)profiles.size());
+    for(std::map<std::string, HouseholdDemandProfilePtr>::iterator it=profiles.begin(); it!=profiles.end(); ++it) {
+        utility::writeBinary(header, it->second->name);
+        utility::writeBinary(header, it->second->firstMinute);
+        utility::writeBinary(header, it->second->resolution);
+        utility::writeBinary(header, (long)it->second->numSlots);
+        for(int j=0; j<it->second->slotMinutes.size(); j++)
+            utility::writeBinary(header, it->second->slotMinutes[j]);
+    }
+    
+    // Only replace previous cache once new one is complete
+    std::string tempFile = cacheFile + ".tmp";
+    std::ofstream out(tempFile.c_str(), std::ios::binary);
+    std::string headerData = header.str();
+    out.write(headerData.data(), headerData.size());
+    long dataStart = ((long)headerData.size() + DEMANDCACHE_ALIGNMENT-1) / DEMANDCACHE_ALIGNMENT * DEMANDCACHE_ALIGNMENT;
+    for(long i=headerData.size(); i<dataStart; i++)
+        out.put(0);
+    for(std::map<std::string, HouseholdDemandProfilePtr>::iterator it=profiles.begin(); it!=profiles.end(); ++it)
+        if(it->second->numSlots > 0)
+            out.write(reinterpret_cast<const char*>(it->second->slots), it->second->numSlots*sizeof(S_Load));
+    out.close();
+    
+    try {
+        if(!out) {
+            boost::filesystem::remove(tempFile);
+            return false;
+        }
+        boost::filesystem::rename(tempFile, cacheFile);
+    }
+    catch(std::exception &e) {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef DEMANDPROFILECACHE_H
+#define	DEMANDPROFILECACHE_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "HouseholdDemandModel.h"
+
+
+/** A compiled binary cache of all demand profiles of a demand data directory.
+  * The file holds a header (the source files it was compiled from, and the 
+  * time grid of each profile, with slot times of irregular profiles) 
+  * followed by one contiguous array of slot loads (see 
+  * HouseholdDemandProfile::buildIndex).  It is memory-mapped when read, 
+  * and profiles point straight into the mapping, so loading takes next to no
+  * time regardless of the number of profiles.  A cache is stale, and not 
+  * used, once any source file is added, removed or modified. */
+class DemandProfileCache {
+public:
+    /** Read profiles from given cache file, if it was compiled from exactly
+      * the given source files, with the same indexing (time of day or 
+      * exact time).  Returns false if the cache is missing, stale or 
+      * invalid. */
+    static bool read(std::string cacheFile, 
+                     std::vector<std::string> sourceFiles, 
+                     bool timeOfDay,
+                     std::map<std::string, HouseholdDemandProfilePtr> &profiles);
+    
+    /** Compile given profiles, read from given source files, into cache 
+      * file.  Returns false on failure. */
+    static bool write(std::string cacheFile, 
+                      std::vector<std::string> sourceFiles, 
+                      bool timeOfDay,
+                      std::map<std::string, HouseholdDemandProfilePtr> &profiles);
+    
+private:
+    /** Write header identifying the source files (name, size, modification
+      * time, in name order) and indexing of cache. */
+    static void writeSources(std::ostream &out, std::vector<std::string> sourceFiles, bool timeOfDay);
+};
+
+#endif	/* DEMANDPROFILECACHE_H */
@@ -41,6 +41,8 @@ Household::Household() {
     componentName = "Noname";
     phase = A;
     demandProfileFactor = 1;
+    for(int i=0; i<4; i++)
+        demandRandomness[i] = 0;
     V_RMS = 0;
     V_Mag = 0;
     V_Pha = 0;
@@ -56,38 +58,38 @@ Household::Household() {
 Household::~Household() {
 }
 
-void Household::setModelType(std::string mt) {
-    modelType = mt;
-}
-
-S_Load Household::getDemandAtTimeOfDay(DateTime datetime) {
-    // This function is used by "generic" demand model -- i.e. date not important
-    
-    // Find the closest demand entry in demandProfile.  This may be
-    // exact, but in certain situations may be slightly later (e.g. if demand data is
-    // in 30-min intervals, but we are running sim in 5-min intervals)
-    for(std::map<DateTime, S_Load>::iterator iter=demandProfile.demand.begin(); iter!=demandProfile.demand.end(); ++iter)
-        if(datetime.timeEquals(iter->first) || datetime.isEarlierInDayThan(iter->first))
-            return iter->second;
+void Household::saveState(std::ostream &out) {
+    random.saveState(out);
     
-    // Should not get here
-    std::cout << "ERROR!  No demand found for house " << name << " at " << datetime.toString() << "!" << std::endl;
-    S_Load error;
-    error.P = 0;
-    error.Q = 0;
+    // Voltages of last load flow (used by e.g. distributed charging)
+    utility::writeBinary(out, V_RMS);
+    utility::writeBinary(out, V_Mag);
+    utility::writeBinary(out, V_Pha);
+}
 
-    return error;
+void Household::loadState(std::istream &in) {
+    random.loadState(in);
+    utility::readBinary(in, V_RMS);
+    utility::readBinary(in, V_Mag);
+    utility::readBinary(in, V_Pha);
 }
 
-S_Load Household::getDemandAtExactTime(DateTime datetime) {
-    // This function is used by specific demand profile -- date matters
+void Household::setModelType(std::string mt) {
+    modelType = mt;
+}
 
+S_Load Household::getDemandAt(DateTime datetime) {
     // Find the closest demand entry in demandProfile.  This may be
     // exact, but in certain situations may be slightly later (e.g. if demand data is
-    // in 30-min intervals, but we are running sim in 5-min intervals)
-    for(std::map<DateTime, S_Load>::iterator iter=demandProfile.demand.begin(); iter!=demandProfile.demand.end(); ++iter)
-        if(datetime.equals(iter->first) || datetime.isEarlierThan(iter->first))
-            return iter->second;
+    // in 30-min intervals, but we are running sim in 5-min intervals).  For the
+    // "generic" demand model, only time of day matters (see buildIndex).
+    const S_Load* demand = demandProfile ? demandProfile->find(datetime) : NULL;
+    if(demand != NULL) {
+        S_Load scaled;
+        scaled.P = demand->P * demandProfileFactor;
+        scaled.Q = demand->Q * demandProfileFactor;
+        return scaled;
+    }
 
     // Should not get here
     std::cout << "ERROR!  No demand found for house " << name << " at " << datetime.toString() << "!" << std::endl;
@@ -98,29 +100,36 @@ S_Load Household::getDemandAtExactTime(DateTime datetime) {
     return error;
 }
 
-S_Load Household::getDemandAt(DateTime datetime) {
-    if(modelType == "generic")
-        return getDemandAtTimeOfDay(datetime);
-    else
-        return getDemandAtExactTime(datetime);
+void Household::setLoadValues(DateTime datetime) {
+    generateLoadValues(datetime, 0, 1, 1, &activePower, &inductivePower, &capacitivePower);
 }
 
-void Household::setLoadValues(DateTime datetime) {
-    S_Load demandNow;
+void Household::generateLoadValues(DateTime start, int interval, int count, size_t stride,
+                                   double* active, double* inductive, double* capacitive) {
+    DateTime datetime = start;
     
-    if(modelType == "generic")
-        demandNow = getDemandAtTimeOfDay(datetime);
-    else
-        demandNow = getDemandAtExactTime(datetime);
+    for(int i=0; i<count; i++, datetime.increment(interval)) {
+        S_Load demandNow = getDemandAt(datetime);
     
-    activePower = demandNow.P;
-    if(demandNow.Q < 0) {
-        inductivePower = 0.000001;
-        capacitivePower = demandNow.Q;
-    }
-    else {
-        inductivePower = demandNow.Q;
-        capacitivePower = 0.000001;
+        // Optional random deviation (in %) from profile, drawn from a separate
+        // stream for each interval so it does not depend on when loads are set
+        if(demandRandomness[1] > 0) {
+            long key = (((long)datetime.year*12 + datetime.month)*31 + datetime.day)*1440 
+                       + datetime.hour*60 + datetime.minute;
+            double factor = 1 + random.substream(key).normal(demandRandomness)/100;
+            demandNow.P *= factor;
+            demandNow.Q *= factor;
+        }
+    
+        active[i*stride] = demandNow.P;
+        if(demandNow.Q < 0) {
+            inductive[i*stride] = 0.000001;
+            capacitive[i*stride] = demandNow.Q;
+        }
+        else {
+            inductive[i*stride] = demandNow.Q;
+            capacitive[i*stride] = 0.000001;
+        }
     }
 }
 
@@ -63,21 +63,26 @@ public:
     std::string componentName;
     
     /** Demand profile: greater than 1 if this is a high-use house,  less
-      * than 1 if it's a low-use house */
+      * than 1 if it's a low-use house.  Scales all demand of the (shared)
+      * profile. */
     double demandProfileFactor;
     
     /** 4-tuple to add normal distribution random effects on household 
-      * demand each interval */
+      * demand each interval (deviation from profile in %) */
     double demandRandomness[4];
     
+    /** Random stream of this household. */
+    RandomStream random;
+    
     /** Phase that this household is connected to. */
     Phase phase;
     
     /** Base voltage of network this household is in. */
     double baseVoltage;
     
-    /** This household's full demand profile for a 24-hour period. */
-    HouseholdDemandProfile demandProfile;
+    /** This household's full demand profile for a 24-hour period (shared
+      * with other households using the same profile, NULL if none). */
+    HouseholdDemandProfilePtr demandProfile;
     
     /** Name of parent pole that this household is connected to. */
     std::string parentPoleName;
@@ -118,7 +123,9 @@ public:
     /** The total impedance*/
     Impedance totalImpedanceToTX;
     
-    /** Active power demand (W) */
+    /** Active power demand (W), as set by setLoadValues.  During simulation
+      * the grid model keeps each interval's household loads instead (see 
+      * GridModel::getHouseholdActive). */
     double activePower;
     
     /** Inductive power demand (W) */
@@ -143,16 +150,24 @@ public:
       * returned. */
     S_Load getDemandAt(DateTime datetime);
     
-    /** Sets active, reactive load values */
+    /** Sets active, reactive load values, including random deviation if any */
     void setLoadValues(DateTime datetime);
     
+    /** Generates load values (as setLoadValues) for count consecutive 
+      * intervals of the given length (minutes) from start, without changing
+      * this household's current loads.  Values for interval i are written to
+      * active[i*stride], inductive[i*stride] and capacitive[i*stride]. */
+    void generateLoadValues(DateTime start, int interval, int count, size_t stride,
+                            double* active, double* inductive, double* capacitive);
+    
+    /** Write state (random stream, voltages of last load flow) to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read state from checkpoint. */
+    void loadState(std::istream &in);
+    
     /** Returns power factor at given date and time */
     double getPowerFactor(DateTime datetime);
-    
-private:
-    // The following two functions are helpers, depending on what demand model type is being used
-    S_Load getDemandAtExactTime(DateTime datetime);
-    S_Load getDemandAtTimeOfDay(DateTime datetime);
 };
 
 #endif	/* HOUSEHOLD_H */
@@ -34,11 +34,16 @@ POSSIBILITY OF SUCH DAMAGE.
 
 
 #include "HouseholdDemandModel.h"
+#include "DemandProfileCache.h"
 
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <ostream>
 
+// Profiles are indexed in slots only while there are at most this many slots
+// per entry (see buildIndex)
+static const long MAX_SLOTS_PER_ENTRY = 4;
+
 HouseholdDemandModel::HouseholdDemandModel(Config* config) {
     std::cout << "Loading household demand model ..." << std::endl;
     
@@ -46,6 +51,10 @@ HouseholdDemandModel::HouseholdDemandModel(Config* config) {
     simInterval = config->getInt("simulationinterval");
     modelType = config->getConfigVar("demandmodel");
     demandDataDir = config->getConfigVar("demanddatadir");
+    useCache = config->getBool("demandcache");
+    numThreads = config->getInt("demandthreads");
+    if(numThreads <= 0)
+        numThreads = boost::thread::hardware_concurrency();
     randomDistribution = config->getRandomParams("demandrandom_int");
     houseProfileAllocFile = config->getConfigVar("housedemandalloc");
 }
@@ -53,15 +62,78 @@ HouseholdDemandModel::HouseholdDemandModel(Config* config) {
 HouseholdDemandModel::~HouseholdDemandModel() {
 }
 
-HouseholdDemandProfile HouseholdDemandModel::inputProfileFromFile(std::string filename) {
+void HouseholdDemandProfile::buildIndex(bool byTimeOfDay) {
+    timeOfDay = byTimeOfDay;
+    slotData.clear();
+    slotMinutes.clear();
+    slots = NULL;
+    numSlots = 0;
+    if(demand.empty())
+        return;
+    
+    // Minute of each entry, in order
+    std::vector<long> minutes;
+    for(std::map<DateTime, S_Load>::iterator it=demand.begin(); it!=demand.end(); ++it) {
+        DateTime time = it->first;
+        minutes.push_back(timeOfDay ? time.totalMinutes() : time.minutesSinceEpoch());
+    }
+    firstMinute = timeOfDay ? 0 : minutes.front();
+    
+    // Entries that are not preceded by a later time (as profiles spanning 
+    // several days can repeat a time of day):  each is the load of all 
+    // times after the previous one, up to its own
+    std::vector<long> entryMinutes;
+    std::vector<S_Load> entryLoads;
+    int i = 0;
+    for(std::map<DateTime, S_Load>::iterator it=demand.begin(); it!=demand.end(); ++it, ++i) {
+        if(entryMinutes.empty() || minutes[i] > entryMinutes.back()) {
+            entryMinutes.push_back(minutes[i]);
+            entryLoads.push_back(it->second);
+        }
+    }
+    
+    // Slot size divides all offsets, so that every entry falls on a slot
+    long gcd = 0;
+    for(i=0; i<entryMinutes.size(); i++) {
+        long a = entryMinutes[i] - firstMinute, b = gcd;
+        while(b > 0) {
+            long remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        gcd = a;
+    }
+    resolution = gcd > 0 ? (int)gcd : 1;
+    long numDenseSlots = (entryMinutes.back() - firstMinute) / resolution + 1;
+    
+    // A single irregular entry can bring slot size down to a minute, so if
+    // slots would far outnumber entries, the entries are searched instead
+    if(numDenseSlots > MAX_SLOTS_PER_ENTRY * (long)entryMinutes.size()) {
+        resolution = 0;
+        slotData.swap(entryLoads);
+        slotMinutes.swap(entryMinutes);
+    }
+    else {
+        slotData.resize(numDenseSlots);
+        size_t slot = 0;
+        for(i=0; i<entryMinutes.size(); i++)
+            for(; slot <= (entryMinutes[i] - firstMinute) / resolution; slot++)
+                slotData[slot] = entryLoads[i];
+    }
+    
+    slots = &slotData[0];
+    numSlots = slotData.size();
+}
+
+HouseholdDemandProfilePtr HouseholdDemandModel::inputProfileFromFile(std::string filename, std::string &error) {
     // Open data file     
     boost::iostreams::stream<boost::iostreams::file_source> infile(filename.c_str());
-    if(!infile){
-       std::cout << "Cannot open household demand data input file " << filename;
-       exit (1);
+    if(!infile || !infile->is_open()){
+       error = "Cannot open household demand data input file " + filename;
+       return HouseholdDemandProfilePtr();
     }
 
-    HouseholdDemandProfile newProfile;
+    HouseholdDemandProfile* newProfile = new HouseholdDemandProfile();
     
     try {
         std::string line;
@@ -70,7 +142,7 @@ HouseholdDemandProfile HouseholdDemandModel::inputProfileFromFile(std::string fi
         S_Load currLoad;
         std::string::size_type start = filename.find_last_of("/\\")+1;
         std::string::size_type end   = filename.find_last_of('.');
-        newProfile.name = filename.substr(start, end-start); 
+        newProfile->name = filename.substr(start, end-start); 
         
 
         while(std::getline(infile,line)) {
@@ -86,18 +158,24 @@ HouseholdDemandProfile HouseholdDemandModel::inputProfileFromFile(std::string fi
             currLoad.Q = utility::string2double(tokens.at(2));
             //std::cout << currDatetime.toString() << " " << currLoad.P << " " << currLoad.Q << std::endl;
             
-            newProfile.demand.insert(std::make_pair(currDatetime, currLoad));
+            newProfile->demand.insert(std::make_pair(currDatetime, currLoad));
         }
 
         infile.close();
     }
     catch(std::exception &e) {
-        std::cout << "\nWARNING: Could not read demand profile info from file " << filename << "!" << std::endl;
+        error = "WARNING: Could not read demand profile info from file " + filename + "!";
     }
-    return newProfile;
+    
+    // Generic profiles apply to any date
+    newProfile->buildIndex(modelType == "generic");
+    return HouseholdDemandProfilePtr(newProfile);
 }
 
 void HouseholdDemandModel::inputProfileAllocationFromFile() {
+    if(!allocationMap.empty())
+        return;
+    
     // Open data file     
     std::ifstream infile(houseProfileAllocFile.c_str());
     if(!infile){
@@ -119,51 +197,126 @@ void HouseholdDemandModel::inputProfileAllocationFromFile() {
 
 void HouseholdDemandModel::inputAllProfiles() {
     std::vector<std::string> fileNames;
-    HouseholdDemandProfile currProfile;
-    int numDemandProfiles = 0;
+    
+    // Profiles are only read once, even if assigned to several grid models
+    if(!demandProfiles.empty())
+        return;
     
     // Regardless of model type, input all profiles in given directory
     fileNames = utility::getAllFileNames(demandDataDir);
+    profileFiles.clear();
     for(int i=0; i<fileNames.size(); i++) {
         std::string::size_type pos1 = fileNames.at(i).find_last_of("/\\");
-        // Ignore files starting with a period (e.g. .DS_Store)
-        if(fileNames.at(i).at(pos1+1) != '.') {
-            currProfile = inputProfileFromFile(fileNames.at(i));
-            demandProfiles[currProfile.name] = currProfile;
-            numDemandProfiles++;
-        }
+        // Ignore files starting with a period (e.g. .DS_Store, or the cache)
+        if(fileNames.at(i).at(pos1+1) != '.')
+            profileFiles.push_back(fileNames.at(i));
+    }
+    
+    // Use compiled profiles if they are up to date
+    std::string cacheFile = (boost::filesystem::path(demandDataDir) / ".possim_demandcache.bin").string();
+    if(useCache && DemandProfileCache::read(cacheFile, profileFiles, modelType == "generic", demandProfiles)) {
+        std::cout << " - found " << demandProfiles.size() << " demand profiles in cache" << std::endl;
+        return;
+    }
+    
+    // Files are read side by side, then added in order of file name (so 
+    // that result does not depend on which thread read what)
+    std::sort(profileFiles.begin(), profileFiles.end());
+    filesRead.assign(profileFiles.size(), HouseholdDemandProfilePtr());
+    fileErrors.assign(profileFiles.size(), std::string());
+    nextFile = 0;
+    numFilesRead = 0;
+    
+    std::cout << " - reading " << profileFiles.size() << " demand profile files ...";
+    std::cout.flush();
+    boost::thread_group threads;
+    for(int i=0; i<std::max(1, std::min(numThreads, (int)profileFiles.size())); i++)
+        threads.create_thread(boost::bind(&HouseholdDemandModel::readProfileFiles, this));
+    threads.join_all();
+    std::cout << " OK" << std::endl;
+    
+    bool failed = false;
+    for(int i=0; i<fileErrors.size(); i++) {
+        if(!fileErrors.at(i).empty())
+            std::cout << fileErrors.at(i) << std::endl;
+        if(!filesRead.at(i))
+            failed = true;
     }
+    if(failed)
+        exit(1);
+    
+    for(int i=0; i<filesRead.size(); i++)
+        demandProfiles[filesRead.at(i)->name] = filesRead.at(i);
+    filesRead.clear();
+    fileErrors.clear();
     
-    std::cout << " - found " << numDemandProfiles << " demand profile files" << std::endl;
+    if(useCache) {
+        if(DemandProfileCache::write(cacheFile, profileFiles, modelType == "generic", demandProfiles))
+            std::cout << " - compiled demand profiles to " << cacheFile << std::endl;
+        else
+            std::cout << " - WARNING: could not write demand profile cache " << cacheFile << std::endl;
+    }
 }
 
-HouseholdDemandProfile HouseholdDemandModel::getRandomProfile() {
-    int index = utility::randomUniform(0, demandProfiles.size()-1);
-    int i=0;
-    for(std::map<std::string,HouseholdDemandProfile>::iterator it=demandProfiles.begin(); it!=demandProfiles.end(); ++it) {
-        if(i == index)
-            return(it->second);
-        i++;
-    }    
-    // Should not reach this point.
-    HouseholdDemandProfile nullProfile;
-    return nullProfile;
+void HouseholdDemandModel::readProfileFiles() {
+    int i;
+    while(true) {
+        {
+            boost::mutex::scoped_lock lock(fileMutex);
+            i = nextFile++;
+        }
+        if(i >= profileFiles.size())
+            return;
+        
+        filesRead.at(i) = inputProfileFromFile(profileFiles.at(i), fileErrors.at(i));
+        
+        // Progress, roughly every 5%
+        boost::mutex::scoped_lock lock(fileMutex);
+        numFilesRead++;
+        if(numFilesRead % std::max(1, (int)profileFiles.size()/20) == 0) {
+            std::cout << " " << numFilesRead*100/profileFiles.size() << "%";
+            std::cout.flush();
+        }
+    }
+}
+
+HouseholdDemandProfilePtr HouseholdDemandModel::getRandomProfile(RandomStream &random) {
+    // Only draw from household's stream if a profile can be returned
+    if(demandProfiles.empty())
+        return HouseholdDemandProfilePtr();
+    
+    int index = random.index(demandProfiles.size());
+    std::map<std::string,HouseholdDemandProfilePtr>::iterator it = demandProfiles.begin();
+    std::advance(it, index);
+    return it->second;
 }
 
 
 void HouseholdDemandModel::assignProfiles(std::map<std::string, Household*> &households) {
     std::cout << " - Assigning demand profiles to houses ... " << std::endl;
+    
+    for(std::map<std::string,Household*>::iterator it=households.begin(); it!=households.end(); ++it)
+        for(int i=0; i<4; i++)
+            it->second->demandRandomness[i] = randomDistribution[i];
 
     if(modelType == "generic") {
         //std::cout << "generic model! ..." << std::endl;
+        if(!genericProfile) {
+            std::string error;
+            genericProfile = inputProfileFromFile(demandDataDir, error);
+            if(!error.empty())
+                std::cout << error << std::endl;
+            if(!genericProfile)
+                exit(1);
+        }
         for(std::map<std::string,Household*>::iterator it=households.begin(); it!=households.end(); ++it)
-            it->second->demandProfile = inputProfileFromFile(demandDataDir);
+            it->second->demandProfile = genericProfile;
     }
 
     else if(modelType == "random") {
         inputAllProfiles();
         for(std::map<std::string,Household*>::iterator it=households.begin(); it!=households.end(); ++it)
-            it->second->demandProfile = getRandomProfile();
+            it->second->demandProfile = getRandomProfile(it->second->random);
     }
 
     else if(modelType == "phasespecific") {
@@ -40,7 +40,12 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <exception>
 #include <stdlib.h>
 #include <vector>
+#include <algorithm>
 #include <map>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include "../simulator/Config.h"
 #include "../utility/DateTime.h"
@@ -49,12 +54,73 @@ POSSIBILITY OF SUCH DAMAGE.
 
 
 /** A full household demand profile for a 24-hour period.  Stores all 
-  * time - load pairs for this profile, plus a unique name for it.  */
+  * time - load pairs for this profile, plus a unique name for it.  For 
+  * lookup during simulation, the pairs are also indexed in a dense array of 
+  * time slots (see buildIndex).  Profiles are read-only once loaded, and 
+  * shared by all households they are assigned to. */
 struct HouseholdDemandProfile {
     std::string name;
     std::map<DateTime, S_Load> demand;
+    
+    /** True if indexed by time of day only (date is ignored) */
+    bool timeOfDay;
+    
+    /** Time of first entry (minutes since midnight if time of day, since 
+      * epoch otherwise) */
+    long firstMinute;
+    
+    /** Minutes between slots:  greatest common divisor of gaps between 
+      * entries.  Zero if entries are too irregular for that (see buildIndex),
+      * in which case there is one slot per entry, at slotMinutes. */
+    int resolution;
+    
+    /** Load of each slot:  that of the first entry at or after slot time.
+      * Points into slotData, or into a memory-mapped profile cache. */
+    const S_Load* slots;
+    
+    /** Number of slots */
+    size_t numSlots;
+    
+    /** Slots built from entries (empty if read from profile cache) */
+    std::vector<S_Load> slotData;
+    
+    /** Time of each slot, in order, if resolution is zero (empty otherwise) */
+    std::vector<long> slotMinutes;
+    
+    /** Profile cache that slots are mapped from, if any */
+    boost::shared_ptr<boost::iostreams::mapped_file_source> mappedFile;
+    
+    HouseholdDemandProfile() : timeOfDay(false), firstMinute(0), resolution(1), slots(NULL), numSlots(0) {}
+    
+    /** Build slot index from demand entries.  Must be called once all
+      * entries are added. */
+    void buildIndex(bool byTimeOfDay);
+    
+    /** Returns load of first entry at or after given time (by time of day,
+      * or by date and time), or NULL if there is none. */
+    const S_Load* find(DateTime datetime) const {
+        long minute = timeOfDay ? datetime.totalMinutes() : datetime.minutesSinceEpoch();
+        if(numSlots == 0)
+            return NULL;
+        if(minute <= firstMinute)
+            return &slots[0];
+        if(resolution == 0) {
+            std::vector<long>::const_iterator next = std::lower_bound(slotMinutes.begin(), slotMinutes.end(), minute);
+            return next != slotMinutes.end() ? &slots[next - slotMinutes.begin()] : NULL;
+        }
+        size_t slot = (minute - firstMinute + resolution - 1) / resolution;
+        return slot < numSlots ? &slots[slot] : NULL;
+    }
+    
+private:
+    // Slots may point into own data, so profiles are not copied
+    HouseholdDemandProfile(const HouseholdDemandProfile&);
+    HouseholdDemandProfile& operator=(const HouseholdDemandProfile&);
 };
 
+/** Shared, read-only handle to a demand profile */
+typedef boost::shared_ptr<const HouseholdDemandProfile> HouseholdDemandProfilePtr;
+
 #include "Household.h"
 
 /** Generates 24-hour demand profiles for households */
@@ -74,8 +140,34 @@ private:
     /** Path to demand data directory */
     std::string demandDataDir;
     
-    /** Map of profile names to full demand profiles */
-    std::map<std::string, HouseholdDemandProfile> demandProfiles;
+    /** True if profiles are read from (and compiled to) a binary cache in 
+      * the demand data directory */
+    bool useCache;
+    
+    /** Number of threads reading profile files */
+    int numThreads;
+    
+    /** Profile files being read by worker threads */
+    std::vector<std::string> profileFiles;
+    
+    /** Profile read from each file */
+    std::vector<HouseholdDemandProfilePtr> filesRead;
+    
+    /** Error reading each file (empty if none), reported once all workers 
+      * are done */
+    std::vector<std::string> fileErrors;
+    
+    /** Index of next file to be read, and number of files read so far */
+    int nextFile, numFilesRead;
+    
+    /** Guards the above while workers are running */
+    boost::mutex fileMutex;
+    
+    /** Map of profile names to full demand profiles, each loaded once */
+    std::map<std::string, HouseholdDemandProfilePtr> demandProfiles;
+    
+    /** Profile of all houses for generic model (loaded once) */
+    HouseholdDemandProfilePtr genericProfile;
     
     /** Path to file indicating phase allocation (which houses are on which phase) */
     std::string houseProfileAllocFile;
@@ -93,18 +185,26 @@ public:
     /** Destructor */
     virtual ~HouseholdDemandModel();
     
-    /** Assign a full 24-hour demand profile to each household */
+    /** Assign a full 24-hour demand profile to each household.  Profile data
+      * is read on first use and kept, so the same demand model can assign 
+      * profiles to several grid models.  Households share the profile data,
+      * so memory grows with the number of distinct profiles only. */
     void assignProfiles(std::map<std::string, Household*> &households);
     
 private:
-    /** Choose a random profile */
-    HouseholdDemandProfile getRandomProfile();
+    /** Choose a random profile, using given stream */
+    HouseholdDemandProfilePtr getRandomProfile(RandomStream &random);
     
     /** Input all profiles in the specified demanddatadir directory */
     void inputAllProfiles();
     
-    /** Input a specific profile from file */
-    HouseholdDemandProfile inputProfileFromFile(std::string filename);
+    /** Worker thread:  read profile files until there are none left. */
+    void readProfileFiles();
+    
+    /** Input a specific profile from file.  Returns no profile if the file
+      * cannot be opened.  Problems are described in given error string 
+      * rather than reported, as files may be read by worker threads. */
+    HouseholdDemandProfilePtr inputProfileFromFile(std::string filename, std::string &error);
     
     /** Input profile allocation from file (matching houses to specific profiles) */
     void inputProfileAllocationFromFile();
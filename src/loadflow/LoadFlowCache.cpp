@@ -0,0 +1,167 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "LoadFlowCache.h"
+
+
+LoadFlowCache::LoadFlowCache(double tol, double maxMemoryMB) {
+    tolerance = tol;
+    maxMemory = (size_t)(maxMemoryMB * 1024 * 1024);
+    memoryUsed = 0;
+    lastHash = 0;
+    hits = 0;
+    misses = 0;
+}
+
+LoadFlowCache::~LoadFlowCache() {
+}
+
+bool LoadFlowCache::lookup(std::vector<double> &active, 
+                           std::vector<double> &inductive, 
+                           std::vector<double> &capacitive,
+                           NetworkData &networkData, 
+                           std::map<std::string,Household*> &households, 
+                           std::map<std::string,FeederLineSegment*> &lineSegments,
+                           std::map<std::string,FeederPole*> &poles) {
+    // Quantize loads, hash
+    int n = active.size();
+    lastKey.resize(3*n);
+    for(int i=0; i<n; i++) {
+        lastKey[3*i]   = (long)floor(active[i]/tolerance + 0.5);
+        lastKey[3*i+1] = (long)floor(inductive[i]/tolerance + 0.5);
+        lastKey[3*i+2] = (long)floor(capacitive[i]/tolerance + 0.5);
+    }
+    lastHash = boost::hash_range(lastKey.begin(), lastKey.end());
+    
+    // Find matching entry (comparing full key, in case of hash collisions)
+    std::pair<std::multimap<size_t,Entry>::iterator, std::multimap<size_t,Entry>::iterator> range = entries.equal_range(lastHash);
+    std::multimap<size_t,Entry>::iterator it;
+    for(it = range.first; it != range.second; ++it)
+        if(it->second.key == lastKey)
+            break;
+    if(it == range.second) {
+        misses++;
+        return false;
+    }
+    hits++;
+    
+    // Copy result out, in same order as stored
+    std::vector<double>::iterator r = it->second.result.begin();
+    for(int i=0; i<12; i++) networkData.phaseV[i] = *r++;
+    for(int i=0; i<12; i++) networkData.phaseI[i] = *r++;
+    for(int i=0; i<12; i++) networkData.eolV[i] = *r++;
+    networkData.iterations = 0;
+    
+    for(std::map<std::string,Household*>::iterator h = households.begin(); h != households.end(); ++h) {
+        h->second->V_RMS = *r++;
+        h->second->V_Mag = *r++;
+        h->second->V_Pha = *r++;
+        h->second->V_unbalance = *r++;
+        h->second->V_0 = *r++;
+        h->second->V_1 = *r++;
+        h->second->V_2 = *r++;
+    }
+    for(std::map<std::string,FeederLineSegment*>::iterator s = lineSegments.begin(); s != lineSegments.end(); ++s)
+        s->second->voltageUnbalance = *r++;
+    for(std::map<std::string,FeederPole*>::iterator p = poles.begin(); p != poles.end(); ++p) {
+        for(int i=0; i<3; i++) {
+            p->second->voltage[i].set(r[0], r[1]);
+            p->second->current[i].set(r[2], r[3]);
+            r += 4;
+        }
+    }
+    return true;
+}
+
+void LoadFlowCache::store(NetworkData &networkData, 
+                          std::map<std::string,Household*> &households, 
+                          std::map<std::string,FeederLineSegment*> &lineSegments,
+                          std::map<std::string,FeederPole*> &poles) {
+    Entry entry;
+    entry.key = lastKey;
+    entry.result.reserve(36 + 7*households.size() + lineSegments.size() + 12*poles.size());
+    
+    for(int i=0; i<12; i++) entry.result.push_back(networkData.phaseV[i]);
+    for(int i=0; i<12; i++) entry.result.push_back(networkData.phaseI[i]);
+    for(int i=0; i<12; i++) entry.result.push_back(networkData.eolV[i]);
+    
+    for(std::map<std::string,Household*>::iterator h = households.begin(); h != households.end(); ++h) {
+        entry.result.push_back(h->second->V_RMS);
+        entry.result.push_back(h->second->V_Mag);
+        entry.result.push_back(h->second->V_Pha);
+        entry.result.push_back(h->second->V_unbalance);
+        entry.result.push_back(h->second->V_0);
+        entry.result.push_back(h->second->V_1);
+        entry.result.push_back(h->second->V_2);
+    }
+    for(std::map<std::string,FeederLineSegment*>::iterator s = lineSegments.begin(); s != lineSegments.end(); ++s)
+        entry.result.push_back(s->second->voltageUnbalance);
+    
+    // Phasor phases are stored in degrees, as expected by Phasor::set
+    for(std::map<std::string,FeederPole*>::iterator p = poles.begin(); p != poles.end(); ++p) {
+        for(int i=0; i<3; i++) {
+            entry.result.push_back(p->second->voltage[i].getAmplitude());
+            entry.result.push_back(p->second->voltage[i].getPhase() * 180/M_PI);
+            entry.result.push_back(p->second->current[i].getAmplitude());
+            entry.result.push_back(p->second->current[i].getPhase() * 180/M_PI);
+        }
+    }
+    
+    size_t entrySize = sizeof(Entry) + entry.key.size()*sizeof(long) + entry.result.size()*sizeof(double);
+    if(entrySize > maxMemory)
+        return;
+    
+    // Evict oldest entries until there is room
+    std::multimap<size_t,Entry>::iterator it;
+    while(memoryUsed + entrySize > maxMemory && !insertionOrder.empty()) {
+        it = entries.find(insertionOrder.front());
+        if(it != entries.end()) {
+            memoryUsed -= sizeof(Entry) + it->second.key.size()*sizeof(long) + it->second.result.size()*sizeof(double);
+            entries.erase(it);
+        }
+        insertionOrder.pop_front();
+    }
+    
+    entries.insert(std::make_pair(lastHash, entry));
+    insertionOrder.push_back(lastHash);
+    memoryUsed += entrySize;
+}
+
+int LoadFlowCache::size() {
+    return entries.size();
+}
+
+size_t LoadFlowCache::getMemoryUsed() {
+    return memoryUsed;
+}
@@ -0,0 +1,124 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef LOADFLOWCACHE_H
+#define	LOADFLOWCACHE_H
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <deque>
+#include <cmath>
+#include <boost/functional/hash.hpp>
+
+#include "../household/Household.h"
+#include "../gridmodel/Feeder.h"
+#include "../gridmodel/NetworkData.h"
+
+
+/** Stores load flow results keyed on the loads they were calculated for, so
+  * that intervals with (near-)identical loads need not be solved again.  Loads
+  * are quantized to a multiple of a given tolerance before being compared, 
+  * i.e. two sets of loads hit the same entry if every load rounds to the same
+  * multiple of the tolerance.  Once the memory cap is reached, the oldest
+  * entries are evicted first. */
+class LoadFlowCache {
+
+private:
+    /** A cached result:  quantized loads it was calculated for, and all 
+      * outputs of the load flow. */
+    struct Entry {
+        std::vector<long> key;
+        std::vector<double> result;
+    };
+    
+    /** Quantization step for loads (W, VAr). */
+    double tolerance;
+    
+    /** Maximum memory used by cached entries (bytes). */
+    size_t maxMemory;
+    
+    /** Memory currently used by cached entries (bytes, approximate). */
+    size_t memoryUsed;
+    
+    /** Cached entries, mapped to hash of their key. */
+    std::multimap<size_t, Entry> entries;
+    
+    /** Hashes of cached entries, oldest first, for eviction. */
+    std::deque<size_t> insertionOrder;
+    
+    /** Key of last lookup, so that a subsequent store need not recompute it. */
+    std::vector<long> lastKey;
+    
+    /** Hash of last lookup. */
+    size_t lastHash;
+    
+public:
+    /** Number of lookups that found a cached result. */
+    long hits;
+    
+    /** Number of lookups that did not find a cached result. */
+    long misses;
+    
+public:
+    /** Constructor.  Tolerance in W/VAr, maximum memory in MB. */
+    LoadFlowCache(double tolerance, double maxMemoryMB);
+    
+    /** Destructor */
+    virtual ~LoadFlowCache();
+    
+    /** Look up result for given loads.  If found, copy it into the given
+      * network data, households, line segments and poles and return true. */
+    bool lookup(std::vector<double> &active, 
+                std::vector<double> &inductive, 
+                std::vector<double> &capacitive,
+                NetworkData &networkData, 
+                std::map<std::string,Household*> &households, 
+                std::map<std::string,FeederLineSegment*> &lineSegments,
+                std::map<std::string,FeederPole*> &poles);
+    
+    /** Store result of load flow for the loads of the last (missed) lookup. */
+    void store(NetworkData &networkData, 
+               std::map<std::string,Household*> &households, 
+               std::map<std::string,FeederLineSegment*> &lineSegments,
+               std::map<std::string,FeederPole*> &poles);
+    
+    /** Number of cached entries. */
+    int size();
+    
+    /** Memory currently used by cached entries (bytes, approximate). */
+    size_t getMemoryUsed();
+};
+
+#endif	/* LOADFLOWCACHE_H */
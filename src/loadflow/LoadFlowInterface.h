@@ -58,6 +58,9 @@ POSSIBILITY OF SUCH DAMAGE.
 class LoadFlowInterface {
 
 public:
+    /** Destructor */
+    virtual ~LoadFlowInterface() {}
+    
     /** Load network model. */
     virtual void loadModel(Config* config) = 0;
     
@@ -72,6 +75,21 @@ public:
     /** Run a load flow simulation. */
     virtual void runSim() = 0;
     
+    /** Update the last load flow solution following a change in demand of
+      * only the given loads (indices into the arrays of the last bulk
+      * setDemand call).  Returns false if not supported by this interface,
+      * in which case a full runSim is required. */
+    virtual bool runIncrementalSim(std::vector<int> changedLoads) = 0;
+    
+    /** Run load flow for several load scenarios at once.  Loads are given as
+      * numScenarios x numLoads matrices (row per scenario), in the order set
+      * by setDemandComponents.  RMS voltage at each household is returned in
+      * houseV as a numScenarios x numHouses matrix (households in order of
+      * their names).  Does not change the state of the model.  Returns false 
+      * if not supported by this interface. */
+    virtual bool runBatchSim(int numScenarios, double* active, double* inductive, 
+                             double* capacitive, double* houseV) = 0;
+    
     /** Get pointer to value of variable having this name. */
     virtual double* getVar(std::string var) = 0;
     
@@ -99,6 +117,14 @@ public:
     /** Set demand of all components specified in given filename. */
     virtual void setDemand(std::string filename) = 0;
     
+    /** Specify (once) the components whose demand will subsequently be set
+      * in bulk, so that names need not be resolved on every load flow. */
+    virtual void setDemandComponents(std::vector<std::string> components) = 0;
+    
+    /** Set demand of all components given to setDemandComponents, in the 
+      * same order.  Arrays must have numLoads entries each. */
+    virtual void setDemand(double* active, double* inductive, double* capacitive, int numLoads) = 0;
+    
     /** Print the model (to pdf in this run's logging directory, ideally). */
     virtual void printModel(std::string targetDir) = 0;
     
@@ -112,6 +138,13 @@ public:
                                 std::map<std::string,FeederLineSegment*> &lineSegments,
                                 std::map<std::string,FeederPole*> &poles) = 0;
     
+    /** Write any state carried from one load flow to the next (e.g. previous
+      * solution used as starting point) to checkpoint. */
+    virtual void saveState(std::ostream &out) = 0;
+    
+    /** Read state carried from one load flow to the next from checkpoint. */
+    virtual void loadState(std::istream &in) = 0;
+    
 };
 
 #endif	/* LOADFLOWINTERFACE_H */
@@ -41,30 +41,19 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <string.h>
 
 #include "engine.h"
 
 #include <boost/filesystem.hpp>
 
 #include "LoadFlowInterface.h"
+#include "ModelFileParser.h"
 #include "../utility/Utility.h"
+#include "../utility/Profiler.h"
 
 #define BUFSIZE 256
 
-// No need to include helper struct in documentation
-/** \cond HIDDEN SYMBOLS */
-
-// Each block port is a pair of block(matlab component) and one of its ports.
-// Each model line in matlab connects a number of block-port pairs.
-struct blockPort {
-    std::string block;
-    std::string port;
-};
-
-
-/** \endcond */
-
-
 /** The interface to MATLAB SimPowerSystems.  The network model is built within
   * MATLAB, then imported into POSSIM here.  Vehicles are added to the MATLAB
   * model as required on the fly.  MATLAB takes care of all load flow
@@ -78,6 +67,10 @@ private:
     /** Necessary to retrieve outputs from MATLAB */
     mxArray *result;
     
+    /** Loads passed to MATLAB in bulk: one row per component, columns are
+      * active, inductive and capacitive power. */
+    mxArray *demandLoads;
+    
     /** Local pointer to config */
     Config *config;
 
@@ -105,6 +98,11 @@ private:
     /** For convenience of string interaction between POSSIM and MATLAB. */
     std::stringstream ss;
     
+    /** For each line segment (in the order of the lineSegments map, i.e. the
+      * order of outputs from MATLAB), the households connected to its child
+      * pole.  Built once in extractModel. */
+    std::vector< std::vector<Household*> > segmentHouseholds;
+    
 public:
     /** Constructor */
     MatlabInterface(Config* config);
@@ -130,6 +128,13 @@ public:
     /** Run MATLAB load flow calculation. */
     void runSim();
     
+    /** Not supported, MATLAB always solves the full network. */
+    bool runIncrementalSim(std::vector<int> changedLoads);
+    
+    /** Not supported, scenarios must be solved one at a time. */
+    bool runBatchSim(int numScenarios, double* active, double* inductive, 
+                     double* capacitive, double* houseV);
+    
     /** Get value of given variable in MATLAB */
     double* getVar(std::string var);
     
@@ -157,6 +162,14 @@ public:
     /** Set demand of components specified in give file. */
     void setDemand(std::string filename);
     
+    /** Store names of components whose demand is set in bulk in the MATLAB
+      * workspace, and allocate the array used to pass their loads. */
+    void setDemandComponents(std::vector<std::string> components);
+    
+    /** Set demand of all components given to setDemandComponents, passing
+      * all loads to MATLAB as a single array. */
+    void setDemand(double* active, double* inductive, double* capacitive, int numLoads);
+    
     /** Print network model (ideally to PDF in simulation log directory) */
     void printModel(std::string targetDir);
     
@@ -170,31 +183,16 @@ public:
                                 std::map<std::string,FeederLineSegment*> &lineSegments,
                                 std::map<std::string,FeederPole*> &poles);
     
+    /** No state is kept between load flows (other than within MATLAB). */
+    void saveState(std::ostream &out);
+    
+    void loadState(std::istream &in);
+    
     /** Run Optimisation in matlab.*/
     void runOptimisationLinear(std::string optDir, std::string optAlg, 
                          int numDecVars, int numConstraints, 
                          double &fval, double &exitflag);
-    
-    
-private:
-    /** Extract information about line segments, houses, and connections between 
-      * blocks from raw matlab model file */
-    void parseModelFile(DistributionTransformer* &transformer,
-                        std::map<std::string,FeederLineSegment*> &lineSegments, 
-                        std::map<std::string,Household*> &households,
-                        std::vector< std::vector<blockPort>  > &modelLines);
-    
-    /** As part of network tree building process, create the root of the tree */
-    void createRoot(FeederPole* &root,
-                    std::map<std::string,Household*> &households,
-                    std::map<std::string,FeederLineSegment*> &lineSegments,
-                    std::vector< std::vector<blockPort> > modelLines);
-
-    void buildTree(FeederLineSegment* &root,
-                   std::map<std::string,FeederPole*> &poles,
-                   std::map<std::string,FeederLineSegment*> &lineSegments,
-                   std::map<std::string,Household*> &households,
-                   std::vector< std::vector<blockPort> > modelLines);
+
 };
 
 #endif	/* MATLABINTERFACE_H */
@@ -0,0 +1,469 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "ModelFileParser.h"
+
+
+
+/*   CONSTRUCTOR, DESTRUCTOR   */
+
+ModelFileParser::ModelFileParser(Config* config) {
+   // Set all names and paths for convenience
+    modelNameFullPath = config->getString("modelpath");
+    std::string::size_type pos=modelNameFullPath.find_last_of("/\\")+1;
+    modelName = modelNameFullPath.substr(pos,modelNameFullPath.length()-pos);
+    modelNameRoot = modelName.substr(0,modelName.find_last_of('.'));
+    
+    modelLibNameFullPath = config->getString("modellibpath");
+    pos=modelLibNameFullPath.find_last_of("/\\")+1;
+    modelLibName = modelLibNameFullPath.substr(pos,modelLibNameFullPath.length()-pos);
+    modelLibNameRoot = modelLibName.substr(0,modelLibName.find_last_of('.'));
+    
+    parsed = false;
+}
+
+ModelFileParser::~ModelFileParser() {
+}
+
+std::string ModelFileParser::getModelNameRoot() {
+    return modelNameRoot;
+}
+
+std::string ModelFileParser::getModelName() {
+    return modelName;
+}
+
+void ModelFileParser::parseModelFile(DistributionTransformer* &transformer, 
+                                     std::map<std::string,FeederLineSegment*> &lineSegments, 
+                                     std::map<std::string,Household*> &households,
+                                     std::vector< std::vector<blockPort>  > &modelLines) {
+    
+   // Ensure both model and its library exist.
+   std::ifstream modelFile(modelNameFullPath.c_str());
+   if(!modelFile){
+       std::cout << "Cannot open model file " << modelNameFullPath << ".  Does it exist?" << std::endl;
+       exit (1);
+   }
+   std::ifstream modelLibraryFile(modelLibNameFullPath.c_str());
+   if(!modelLibraryFile){
+       std::cout << "Cannot open model library file " << modelLibNameFullPath << ".  Does it exist?" << std::endl;
+       exit (1);
+   }
+
+   // Set house and line lib component names
+   ss.str("");
+   ss << "\"" << modelLibNameRoot << "/Individual House\"";
+   std::string modelLibHouse = ss.str();
+   ss.str("");
+   ss << "\"" << modelLibNameRoot << "/Backbone\"";
+   std::string modelLibBackbone = ss.str();
+
+   // Some utility variables
+   std::string line;
+   std::vector<std::string> tokens;
+   std::string::size_type pos1, pos2;
+   std::string key, value;
+   std::map<std::string, std::string> currBlock;
+   blockPort thisBP;
+   std::vector<blockPort> thisModelLine;
+   bool isHouse, isPowerLine, isRoot, isTransformer, isBackboneModel, isServiceLineModel;
+    
+   // NMI counter
+   int NMIcounter = 1;
+   
+   // Line models
+   lineModel backbone, serviceline;
+   
+   // First, get model of lines (backbone and service) from library file
+   while(getline(modelLibraryFile,line)) {
+       utility::tokenize(line, tokens, "\t ");
+
+       // If we are starting a new block
+       if(tokens.size() == 2 && tokens.at(0) == "Block" && tokens.at(1) == "{") {
+           currBlock.clear();
+           isBackboneModel = false;
+           isServiceLineModel = false;
+       
+           int depthCounter = 1;
+
+           // Looping through all parts of this line including branches
+           while(depthCounter > 0) {
+                getline(modelLibraryFile,line);
+                utility::tokenize(line, tokens, "\t ");
+                
+                // Keep track of depth
+                if(tokens.size() == 2 && tokens.at(1) == "{")
+                    depthCounter++;
+                else if(tokens.size() == 1 && tokens.at(0) == "}")
+                    depthCounter--;
+                
+                // Search all blocks
+                else {
+                    // Find key and value of this line
+                    key = tokens.at(0);
+                    pos1 = line.find_first_not_of("\t ", 0);
+                    pos2     = line.find_first_of("\t", pos1);
+                    pos1 = line.find_first_not_of("\t ", pos2+1);
+                    value = line.substr(pos1, line.length()-pos1);
+                           
+                    // Is this a backbone or service line model?
+                    if(key == "Name" && value == "\"Backbone\"")
+                        isBackboneModel = true;
+                    else if(key == "Name" &&
+                            (value == "\"Service Active\"" || value == "\"Service_Active\""))
+                        isServiceLineModel = true;
+                    currBlock[key] = value;
+                }
+           }
+
+           if(isBackboneModel) {
+               backbone.resistance = utility::string2double(currBlock["Resistance"].substr(1,currBlock["Resistance"].length()-2));
+               backbone.inductance = utility::string2double(currBlock["Inductance"].substr(1,currBlock["Inductance"].length()-2));
+               backbone.capacitance = utility::string2double(currBlock["Capacitance"].substr(1,currBlock["Capacitance"].length()-2));
+               std::cout << " - Found backbone line model, with resistance " << std::setprecision(4) << backbone.resistance 
+                         << ", inductance " << std::setprecision(4) << backbone.inductance
+                         << ", capacitance " << std::setprecision(4) << backbone.capacitance << std::endl;
+           }
+           else if(isServiceLineModel) {
+               serviceline.resistance = utility::string2double(currBlock["Resistance"].substr(1,currBlock["Resistance"].length()-2));
+               serviceline.inductance = utility::string2double(currBlock["Inductance"].substr(1,currBlock["Inductance"].length()-2));
+               serviceline.capacitance = utility::string2double(currBlock["Capacitance"].substr(1,currBlock["Capacitance"].length()-2));
+               std::cout << " - Found  service line model, with resistance " << std::setprecision(4) << serviceline.resistance 
+                         << ", inductance " << std::setprecision(4) << serviceline.inductance
+                         << ", capacitance " << std::setprecision(4) << serviceline.capacitance << std::endl;
+           }
+       }
+   }
+   
+   // Second, read all blocks by looping through entire model file
+   while(getline(modelFile,line)) {
+       utility::tokenize(line, tokens, "\t "); 
+
+       // If we are starting a new block
+       if(tokens.size() == 2 && tokens.at(0) == "Block" && tokens.at(1) == "{") {
+           currBlock.clear();
+           isHouse = false;
+           isRoot = false;
+           isPowerLine = false;
+           isTransformer = false;
+           
+           getline(modelFile,line);
+           utility::tokenize(line, tokens, "\t ");
+           
+           // Loop until end of block
+           while(!(tokens.size()<2 && tokens.at(0)=="}")) {
+               
+               // Find key and value of this line
+               key = tokens.at(0);
+               pos1 = line.find_first_not_of("\t ", 0);
+               pos2     = line.find_first_of("\t ", pos1);
+               pos1 = line.find_first_not_of("\t ", pos2+1);
+               value = line.substr(pos1, line.length()-pos1);
+               
+               // Is this a house?  If so make sure to add it to houses
+               if(key == "SourceBlock" && value == modelLibHouse)
+                   isHouse = true;
+               
+               // Is this a power line?  If so make sure to add to powerLines
+               else if(key == "SourceBlock" && value == modelLibBackbone)
+                   isPowerLine = true;
+               
+               // Is this the distribution transformer?  If so store values
+               else if(key == "SourceType" && (value == "\"Three-Phase Transformer (Two Windings)\""))
+                   isTransformer = true;
+               
+               // Is this the tree root (input into distribution network)?
+               else if(key == "Name" && (value=="\"PhaseA\"" || value=="\"PhaseB\"" || value=="\"PhaseC\"" || value=="\"Neutral\""))
+                   isRoot = true;
+
+               currBlock[key] = value;
+
+               getline(modelFile,line);
+               utility::tokenize(line, tokens, "\t ");
+           }
+          
+           if(isHouse) {
+               Household *newHouse = new Household();
+               newHouse->name = utility::stripQuotations(currBlock["Name"]);
+               newHouse->NMI = NMIcounter;
+               NMIcounter++;
+               newHouse->serviceLine.resistance = serviceline.resistance;
+               newHouse->serviceLine.inductance = serviceline.inductance;
+               newHouse->serviceLine.capacitance = serviceline.capacitance;
+               newHouse->serviceLine.length = utility::string2double(utility::stripQuotations(currBlock["length"]));
+               newHouse->hasParent = false;
+               newHouse->componentName = modelNameRoot + "/" + newHouse->name + "/House";
+               households[newHouse->name] = newHouse;
+           }
+           else if(isPowerLine) {
+               FeederLineSegment *newFeederLineSegment = new FeederLineSegment();
+               newFeederLineSegment->name = utility::stripQuotations(currBlock["Name"]);
+               newFeederLineSegment->line.resistance = backbone.resistance;
+               newFeederLineSegment->line.inductance = backbone.inductance;
+               newFeederLineSegment->line.capacitance = backbone.capacitance;                              
+               newFeederLineSegment->line.length = utility::string2double(utility::stripQuotations(currBlock["length"]));
+               lineSegments[newFeederLineSegment->name] = newFeederLineSegment;
+           }
+           else if(isTransformer) {
+               transformer->name = utility::stripQuotations(currBlock["Name"]);
+               std::string nomPower = currBlock["NominalPower"].substr(2,currBlock["NominalPower"].find_first_of(",")-2);
+               transformer->capacity = utility::string2double(nomPower);
+               std::string vOut = currBlock["Winding2"];
+               std::string::size_type p1 = vOut.find_first_of("[")+1;
+               std::string::size_type p2 = vOut.find_first_of(" ", p1+1);
+               vOut = vOut.substr(p1, p2-p1);
+               transformer->voltageOut = utility::string2double(vOut) / std::sqrt(3.0);
+               std::cout << " - Found transformer with capacity " 
+                         << std::setprecision(0) << transformer->capacity/1000 << " kVA" 
+                         << " and output voltage " << transformer->voltageOut << std::endl;
+               
+               std::cout << " - Parsing the rest of the matlab model ... \n";
+           }
+           //else if(isRoot)
+           //    rootBlocks.push_back(currBlock);
+       }
+       
+       // If we have found the start of a model line
+       else if(tokens.size() == 2 && tokens.at(0) == "Line" && tokens.at(1) == "{") {
+           int innerDepthCounter = 1;
+           thisModelLine.clear();
+           
+           // Looping through all parts of this line including branches
+           while(innerDepthCounter > 0) {
+                getline(modelFile,line);
+                utility::tokenize(line, tokens, "\t ");
+                
+                // Keep track of depth
+                if(tokens.size() == 2 && tokens.at(1) == "{")
+                    innerDepthCounter++;
+                else if(tokens.size() == 1 && tokens.at(0) == "}")
+                    innerDepthCounter--;
+                
+                // Store all block names and ports.  SRC or DST doesn't matter.
+                else if(tokens.at(0) == "SrcBlock" || tokens.at(0) == "DstBlock") {
+                    pos1 = line.find_first_not_of("\t ", 0);
+                    pos2     = line.find_first_of("\t ", pos1);
+                    pos1 = line.find_first_not_of("\t ", pos2+1);
+                    value = line.substr(pos1, line.length()-pos1);
+                    thisBP.block = value;
+                    getline(modelFile,line);
+                    utility::tokenize(line, tokens, "\t ");
+                    thisBP.port = tokens.at(1);
+                    thisModelLine.push_back(thisBP);
+                }
+           }
+           
+           modelLines.push_back(thisModelLine);
+       }
+   }
+}
+
+
+void ModelFileParser::createRoot(FeederPole* &root,
+                                 std::map<std::string,Household*> &households,
+                                 std::map<std::string,FeederLineSegment*> &lineSegments,
+                                 std::vector< std::vector<blockPort> > &modelLines) {
+    
+    root = new FeederPole();
+    root->name = "Root";
+
+    // iterate through all model lines
+    for(std::vector< std::vector<blockPort> >::iterator it_outer=modelLines.begin(); it_outer!=modelLines.end(); ++it_outer) {
+        bool isRoot = false;
+        Phase thisPhase;
+        
+        // within each model line, iterate once through all connected components, checking if this line connects to root
+        for(std::vector<blockPort>::iterator it_inner=it_outer->begin(); it_inner!=it_outer->end(); ++it_inner) {
+            if(it_inner->block == "\"PhaseA\"") {
+                isRoot = true;
+                thisPhase = A;
+            }
+            if(it_inner->block == "\"PhaseB\"") {
+                isRoot = true;
+                thisPhase = B;
+            }
+            if(it_inner->block == "\"PhaseC\"") {
+                isRoot = true;
+                thisPhase = C;
+            }
+
+        }
+        
+        // if this model line is connected to root, add any connected houses and lines to pole (ensuring no duplicates)
+        if(isRoot) {
+            for(std::vector<blockPort>::iterator it_inner=it_outer->begin(); it_inner!=it_outer->end(); ++it_inner){
+                std::string thisBlockName = utility::stripQuotations(it_inner->block);
+                if(households.find(thisBlockName) != households.end()) {
+                    households[thisBlockName]->phase = thisPhase;
+                    households[thisBlockName]->hasParent = true;
+                    households[thisBlockName]->parentPoleName = root->name;
+                    // Only add if it's not already there
+                    if(std::find(root->households.begin(), root->households.end(), households[thisBlockName]) == root->households.end())
+                        root->households.push_back(households[thisBlockName]);
+                }
+                else if(lineSegments.find(thisBlockName) != lineSegments.end()) {
+                    lineSegments[thisBlockName]->parentPole = root;
+                    lineSegments[thisBlockName]->parentPoleName = root->name;
+                    // Only add if it's not already there
+                    if(std::find(root->childLineSegments.begin(), root->childLineSegments.end(), lineSegments[thisBlockName]) == root->childLineSegments.end())
+                        root->childLineSegments.push_back(lineSegments[thisBlockName]);
+                }
+            }
+        }
+    }
+}
+
+int find_portnum(std::string portname) {
+    // num is last character of name
+    return utility::string2int(portname.substr(portname.length()-1, 1));
+}
+
+void ModelFileParser::buildTree(FeederLineSegment* &root,
+                                std::map<std::string,FeederPole*> &poles,
+                                std::map<std::string,FeederLineSegment*> &lineSegments,
+                                std::map<std::string,Household*> &households,
+                                std::vector< std::vector<blockPort> > &modelLines) {
+    
+    bool foundConnections = false;
+    Phase thisPhase;
+    
+    FeederPole* newPole = new FeederPole();
+    newPole->name = "Pole_" + root->name;
+    newPole->parentLineSegment = root;
+    
+    // iterate through all model lines
+    for(std::vector< std::vector<blockPort> >::iterator it_outer=modelLines.begin(); it_outer!=modelLines.end(); ++it_outer) {
+        bool isConnected = false;
+ 
+        // within each model line, iterate once through all connected components, 
+        // checking if this line connects to root (note: ignore neutral line)
+        for(std::vector<blockPort>::iterator it_inner=it_outer->begin(); it_inner!=it_outer->end(); ++it_inner)
+            if(utility::stripQuotations(it_inner->block) == root->name && find_portnum(it_inner->port) != 4) {
+                isConnected = true;
+                foundConnections = true;
+                thisPhase = Phase(find_portnum(it_inner->port) - 1);
+                break;
+            }
+
+        // if this model line is connected to root, add any connected houses and lines to pole (ensuring no duplicates)
+        if(isConnected) {
+            for(std::vector<blockPort>::iterator it_inner=it_outer->begin(); it_inner!=it_outer->end(); ++it_inner){
+                std::string thisBlockName = utility::stripQuotations(it_inner->block);
+                
+                // if there is a house on this line
+                if(households.find(thisBlockName) != households.end()) {
+                    // make sure this house doesn't already have a parent
+                    if(!households[thisBlockName]->hasParent) {
+                        households[thisBlockName]->phase = thisPhase;
+                        households[thisBlockName]->hasParent = true;
+                        households[thisBlockName]->parentPoleName = newPole->name;
+                        // if not already added (not sure if it ever would be), add to list for this pole
+                        if(std::find(newPole->households.begin(), newPole->households.end(), households[thisBlockName]) == newPole->households.end())
+                            newPole->households.push_back(households[thisBlockName]);
+                    }
+                }
+                
+                // if there is a powerLine on this line
+                else if(lineSegments.find(thisBlockName) != lineSegments.end()) {
+                    // make sure it doesn't already have a parent 
+                    // (would need to change this for non-radial networks)
+                    if(lineSegments[thisBlockName]->parentPoleName.empty()) {
+                        lineSegments[thisBlockName]->parentPole = newPole;
+                        lineSegments[thisBlockName]->parentPoleName = newPole->name;
+                        // if not already added (not sure why it would be), add to list for this pole
+                        if(std::find(newPole->childLineSegments.begin(), newPole->childLineSegments.end(), lineSegments[thisBlockName]) == newPole->childLineSegments.end())
+                            newPole->childLineSegments.push_back(lineSegments[thisBlockName]);
+                    }
+                }
+            }
+        }
+    }
+    
+    if(foundConnections) {
+        poles[newPole->name] = newPole;
+        root->childPole = newPole;
+        root->childPoleName = newPole->name;
+        //std::cout << "Adding Pole " << newPole->name
+        //     << " (parent " << newPole->parentLineSegment->name << ")"
+        //     << " with " << (newPole->households.empty()?0:newPole->households.size()) << " houses (";
+        //for(int i=0; i<newPole->households.size(); i++)
+        //    std::cout << newPole->households.at(i)->name << ",";
+        //std::cout << ") and " << (newPole->childLineSegments.empty()?0:newPole->childLineSegments.size()) << " child lines (";
+        //for(int i=0; i<newPole->childLineSegments.size(); i++)
+        //    std::cout << newPole->childLineSegments.at(i)->name << ",";
+        //std::cout << ")" << std::endl;
+        for(int i=0; i<newPole->childLineSegments.size(); i++)
+            buildTree(newPole->childLineSegments.at(i), poles, lineSegments, households, modelLines);
+    }
+}
+
+
+
+void ModelFileParser::extractModel(FeederPole* &root, 
+                                   DistributionTransformer* &transformer,
+                                   std::map<std::string,FeederPole*> &poles, 
+                                   std::map<std::string,FeederLineSegment*> &lineSegments, 
+                                   std::map<std::string,Household*> &households) {
+    
+    // The model file is only parsed once.  Later calls (e.g. for further
+    // ensemble members) build their tree from copies of the parsed components.
+    if(!parsed) {
+        parseModelFile(transformer, lineSegments, households, modelLines);
+        parsedTransformer = *transformer;
+        for(std::map<std::string,FeederLineSegment*>::iterator it = lineSegments.begin(); it != lineSegments.end(); ++it)
+            parsedLineSegments[it->first] = *(it->second);
+        for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it)
+            parsedHouseholds[it->first] = *(it->second);
+        parsed = true;
+    }
+    else {
+        *transformer = parsedTransformer;
+        for(std::map<std::string,FeederLineSegment>::iterator it = parsedLineSegments.begin(); it != parsedLineSegments.end(); ++it)
+            lineSegments[it->first] = new FeederLineSegment(it->second);
+        for(std::map<std::string,Household>::iterator it = parsedHouseholds.begin(); it != parsedHouseholds.end(); ++it)
+            households[it->first] = new Household(it->second);
+    }
+    std::cout << " - Model contains " << households.size() << " houses, " 
+                         << lineSegments.size() << " feeder line segments, and " 
+                         << modelLines.size() << " model lines." << std::endl;
+    
+    // Create root       
+    createRoot(root, households, lineSegments, modelLines);
+    poles[root->name] = root;
+ 
+    // Recursively build tree
+    std::cout << " - Building network tree ..." << std::endl;
+    for(int i=0; i<root->childLineSegments.size(); i++)
+        buildTree(root->childLineSegments.at(i), poles, lineSegments, households, modelLines);
+}
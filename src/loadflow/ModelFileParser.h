@@ -0,0 +1,159 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef MODELFILEPARSER_H
+#define	MODELFILEPARSER_H
+
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <map>
+
+#include "../simulator/Config.h"
+#include "../household/Household.h"
+#include "../gridmodel/Feeder.h"
+#include "../gridmodel/DistributionTransformer.h"
+#include "../utility/Utility.h"
+
+// No need to include helper struct in documentation
+/** \cond HIDDEN SYMBOLS */
+
+// Each block port is a pair of block(matlab component) and one of its ports.
+// Each model line in matlab connects a number of block-port pairs.
+struct blockPort {
+    std::string block;
+    std::string port;
+};
+
+
+/** \endcond */
+
+
+/** Reads a network model built in MATLAB SimPowerSystems directly from its
+  * .mdl file (and the accompanying library file), and builds the network
+  * tree of poles, line segments and households from it.  No MATLAB session is
+  * required, so the same parser serves both the MATLAB interface and any
+  * native load flow solvers. */
+class ModelFileParser {
+    
+private:
+    /** Name of network model. */
+    std::string modelName;
+    
+    /** Name of network model without extension. */
+    std::string modelNameRoot;
+    
+    /** Name of full path and model. */
+    std::string modelNameFullPath;
+        
+    /** Name of network model library. */
+    std::string modelLibName;
+    
+    /** Name of network model library without extension. */
+    std::string modelLibNameRoot;
+    
+    /** Name of full path and model library. */
+    std::string modelLibNameFullPath;
+    
+    /** For convenience of string manipulation. */
+    std::stringstream ss;
+    
+    /** True once the model file has been parsed. */
+    bool parsed;
+    
+    /** Lines within the model file, each connecting a number of block-port
+      * pairs (not to be confused with feeder line segments). */
+    std::vector< std::vector<blockPort> > modelLines;
+    
+    /** Transformer as parsed from the model file. */
+    DistributionTransformer parsedTransformer;
+    
+    /** Line segments as parsed from the model file, before tree is built. */
+    std::map<std::string,FeederLineSegment> parsedLineSegments;
+    
+    /** Households as parsed from the model file, before tree is built. */
+    std::map<std::string,Household> parsedHouseholds;
+    
+public:
+    /** Constructor */
+    ModelFileParser(Config* config);
+    
+    /** Destructor */
+    ~ModelFileParser();
+    
+    /** Name of the network model without path or extension. */
+    std::string getModelNameRoot();
+    
+    /** Name of the network model without path. */
+    std::string getModelName();
+    
+    /** Parse the model file.  Read full network structure and any relevant
+      * information for individual components, and build the network tree.
+      * Households are given a default component name based on the model and
+      * house name; interfaces that know better may overwrite it.  The file is
+      * only read on the first call, later calls build a new network tree 
+      * from the components parsed then. */
+    void extractModel(FeederPole* &root, 
+                      DistributionTransformer* &transformer,
+                      std::map<std::string,FeederPole*> &poles, 
+                      std::map<std::string,FeederLineSegment*> &lineSegments, 
+                      std::map<std::string,Household*> &households);
+    
+private:
+    /** Extract information about line segments, houses, and connections between 
+      * blocks from raw matlab model file */
+    void parseModelFile(DistributionTransformer* &transformer,
+                        std::map<std::string,FeederLineSegment*> &lineSegments, 
+                        std::map<std::string,Household*> &households,
+                        std::vector< std::vector<blockPort>  > &modelLines);
+    
+    /** As part of network tree building process, create the root of the tree */
+    void createRoot(FeederPole* &root,
+                    std::map<std::string,Household*> &households,
+                    std::map<std::string,FeederLineSegment*> &lineSegments,
+                    std::vector< std::vector<blockPort> > &modelLines);
+
+    /** Recursively build the tree below the given line segment */
+    void buildTree(FeederLineSegment* &root,
+                   std::map<std::string,FeederPole*> &poles,
+                   std::map<std::string,FeederLineSegment*> &lineSegments,
+                   std::map<std::string,Household*> &households,
+                   std::vector< std::vector<blockPort> > &modelLines);
+};
+
+#endif	/* MODELFILEPARSER_H */
+
@@ -0,0 +1,658 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+
+
+#include "NativeInterface.h"
+
+
+
+/*   CONSTRUCTOR, DESTRUCTOR   */
+    
+NativeInterface::NativeInterface(Config* cfg) {
+    // Store local pointer to config
+    config = cfg;
+    parser = new ModelFileParser(config);
+    ownsParser = true;
+    initialise();
+}
+
+NativeInterface::NativeInterface(Config* cfg, ModelFileParser* sharedParser) {
+    // Store local pointer to config
+    config = cfg;
+    parser = sharedParser;
+    ownsParser = false;
+    initialise();
+}
+
+void NativeInterface::initialise() {
+    frequency = config->getDouble("frequency");
+    baseVoltage = config->getDouble("basevoltage");
+    tolerance = config->getDouble("loadflowtolerance");
+    maxIterations = config->getInt("loadflowmaxiter");
+    warmStart = config->getBool("loadflowwarmstart");
+    numIterations = 0;
+    eolIndex = 0;
+    hasSolution = false;
+    
+    std::cout << " - Using native load flow solver ... OK" << std::endl;
+}
+
+NativeInterface::~NativeInterface() {
+    if(ownsParser)
+        delete parser;
+}
+
+
+void NativeInterface::loadModel(Config* config) {
+}
+
+void NativeInterface::extractModel(FeederPole* &root, 
+                                   DistributionTransformer* &transformer,
+                                   std::map<std::string,FeederPole*> &poles, 
+                                   std::map<std::string,FeederLineSegment*> &lineSegments, 
+                                   std::map<std::string,Household*> &households) {
+    
+    // Read network structure from the model file, build tree
+    parser->extractModel(root, transformer, poles, lineSegments, households);
+    modelNameRoot = parser->getModelNameRoot();
+    
+    std::cout << " - Preparing network for native solver ...";
+    std::cout.flush();
+    
+    // Balanced source at transformer: phases at 0, -120, +120 degrees
+    for(int p=0; p<3; p++)
+        sourceV[p] = std::polar(transformer->voltageOut, 2*M_PI*(-p)/3);
+    
+    // Flattened network:  a single forward pass over the arrays visits 
+    // parents before children, a backward pass children before parents
+    network.compile(root, poles, households);
+    
+    double omega = 2*M_PI*frequency;
+    std::vector<double> distance(network.numPoles, 0);
+    segmentZ.assign(network.numPoles, std::complex<double>(0,0));
+    eolIndex = 0;
+    for(int i=1; i<network.numPoles; i++) {
+        segmentZ[i] = std::complex<double>(network.segmentR[i], omega*network.segmentL[i]);
+        distance[i] = distance[network.parent[i]] + std::abs(segmentZ[i]);
+        if(distance[i] > distance[eolIndex])
+            eolIndex = i;
+    }
+    
+    // Households and their loads
+    houseServiceZ.clear();
+    componentIndex.clear();
+    componentS.clear();
+    componentHouse.clear();
+    demandComponents.clear();
+    houseComponents.clear();
+    for(int h=0; h<network.numHouses; h++) {
+        houseServiceZ.push_back(std::complex<double>(network.serviceR[h], omega*network.serviceL[h]));
+        componentIndex[network.houses[h]->componentName] = componentS.size();
+        componentS.push_back(std::complex<double>(0,0));
+        componentHouse.push_back(h);
+        houseComponents.push_back(std::vector<int>(1, componentS.size()-1));
+    }
+    houseS.assign(network.numHouses, std::complex<double>(0,0));
+    
+    flatStart();
+    deltaI.assign(4*network.numPoles, std::complex<double>(0,0));
+    deltaV.assign(4*network.numPoles, std::complex<double>(0,0));
+    
+    std::cout << " OK" << std::endl;
+}
+    
+void NativeInterface::runSim() {
+    int numPoles = network.numPoles;
+    int numHouses = network.numHouses;
+    int pole, phase;
+    double maxChange, change;
+    std::complex<double> Y, Vpn, Vnew;
+    
+    // Start from previous solution if available (loads usually change
+    // only slightly from one interval to the next)
+    if(!warmStart || !hasSolution)
+        flatStart();
+    
+    // Aggregate component loads into household loads
+    houseS.assign(numHouses, std::complex<double>(0,0));
+    for(int c=0; c<componentS.size(); c++)
+        houseS[componentHouse[c]] += componentS[c];
+    
+    for(numIterations=1; numIterations<=maxIterations; numIterations++) {
+        
+        // Backward sweep:  household currents, accumulated from leaves to root
+        I.assign(4*numPoles, std::complex<double>(0,0));
+        for(int h=0; h<numHouses; h++) {
+            pole = network.housePole[h];
+            phase = network.housePhase[h];
+            if(phase < 0 || phase > 2)
+                continue;
+            
+            // Constant impedance load behind active and neutral service conductors
+            Y = std::conj(houseS[h]) / (baseVoltage*baseVoltage);
+            Vpn = V[4*pole+phase] - V[4*pole+3];
+            houseI[h] = Y*Vpn / (1.0 + 2.0*houseServiceZ[h]*Y);
+            
+            I[4*pole+phase] += houseI[h];
+            I[4*pole+3] -= houseI[h];
+        }
+        for(int i=numPoles-1; i>0; i--)
+            for(int p=0; p<4; p++)
+                I[4*network.parent[i]+p] += I[4*i+p];
+        
+        // Forward sweep:  voltage drops from root to leaves
+        maxChange = 0;
+        for(int i=1; i<numPoles; i++) {
+            for(int p=0; p<4; p++) {
+                Vnew = V[4*network.parent[i]+p] - segmentZ[i]*I[4*i+p];
+                change = std::abs(Vnew - V[4*i+p]);
+                if(change > maxChange)
+                    maxChange = change;
+                V[4*i+p] = Vnew;
+            }
+        }
+        
+        if(maxChange < tolerance)
+            break;
+    }
+    
+    if(numIterations > maxIterations) {
+        std::cout << " (WARNING: load flow did not converge after " 
+                  << maxIterations << " iterations)";
+        numIterations = maxIterations;
+    }
+    hasSolution = true;
+}
+
+bool NativeInterface::runIncrementalSim(std::vector<int> changedLoads) {
+    if(!hasSolution)
+        return false;
+    
+    int numPoles = network.numPoles;
+    int house, pole, phase;
+    std::complex<double> Y, Vpn, newI, dI;
+    std::vector<int> changedHouses;
+    
+    for(int i=0; i<changedLoads.size(); i++) {
+        house = componentHouse[demandComponents.at(changedLoads.at(i))];
+        if(std::find(changedHouses.begin(), changedHouses.end(), house) == changedHouses.end())
+            changedHouses.push_back(house);
+    }
+    
+    // Change in current of each affected house, added along its path to root
+    deltaI.assign(4*numPoles, std::complex<double>(0,0));
+    for(int i=0; i<changedHouses.size(); i++) {
+        house = changedHouses.at(i);
+        pole = network.housePole[house];
+        phase = network.housePhase[house];
+        if(phase < 0 || phase > 2)
+            continue;
+        
+        houseS[house] = std::complex<double>(0,0);
+        for(int c=0; c<houseComponents[house].size(); c++)
+            houseS[house] += componentS[houseComponents[house][c]];
+        
+        Y = std::conj(houseS[house]) / (baseVoltage*baseVoltage);
+        Vpn = V[4*pole+phase] - V[4*pole+3];
+        newI = Y*Vpn / (1.0 + 2.0*houseServiceZ[house]*Y);
+        dI = newI - houseI[house];
+        houseI[house] = newI;
+        
+        for( ; pole>=0; pole=network.parent[pole]) {
+            deltaI[4*pole+phase] += dI;
+            deltaI[4*pole+3] -= dI;
+        }
+    }
+    
+    // Every pole shares at least the first segment with the changed houses,
+    // so voltages everywhere shift:  by the accumulated drop along the
+    // shared part of the path
+    for(int p=0; p<4; p++) {
+        I[p] += deltaI[p];
+        deltaV[p] = 0;
+    }
+    for(int i=1; i<numPoles; i++) {
+        for(int p=0; p<4; p++) {
+            I[4*i+p] += deltaI[4*i+p];
+            deltaV[4*i+p] = deltaV[4*network.parent[i]+p] - segmentZ[i]*deltaI[4*i+p];
+            V[4*i+p] += deltaV[4*i+p];
+        }
+    }
+    
+    return true;
+}
+
+bool NativeInterface::runBatchSim(int numScenarios, double* active, double* inductive, 
+                                  double* capacitive, double* houseV) {
+    int S = numScenarios;
+    int numPoles = network.numPoles;
+    int numHouses = network.numHouses;
+    int numLoads = demandComponents.size();
+    int pole, phase, house, iterations;
+    double Vb2 = baseVoltage*baseVoltage;
+    double maxChange, dr, di;
+    
+    // Household loads per scenario
+    std::vector<double> P(numHouses*S, 0), Q(numHouses*S, 0);
+    for(int k=0; k<numLoads; k++) {
+        house = componentHouse[demandComponents[k]];
+        for(int s=0; s<S; s++) {
+            P[house*S+s] += active[s*numLoads+k];
+            Q[house*S+s] += inductive[s*numLoads+k] + capacitive[s*numLoads+k];
+        }
+    }
+    
+    // Constant impedance load behind service line:  I = Yeff*Vpn, where 
+    // Yeff = Y/(1+2ZsY), and voltage across load is Vpn*Yeff/Y = Vpn/(1+2ZsY)
+    std::vector<double> Yr(numHouses*S), Yi(numHouses*S), Hr(numHouses*S), Hi(numHouses*S);
+    double gr, gi, zr, zi, dre, dim, mag;
+    for(int h=0; h<numHouses; h++) {
+        zr = 2*houseServiceZ[h].real();
+        zi = 2*houseServiceZ[h].imag();
+        for(int s=0; s<S; s++) {
+            gr = P[h*S+s] / Vb2;
+            gi = -Q[h*S+s] / Vb2;
+            dre = 1 + zr*gr - zi*gi;
+            dim = zr*gi + zi*gr;
+            mag = dre*dre + dim*dim;
+            Hr[h*S+s] = dre/mag;
+            Hi[h*S+s] = -dim/mag;
+            Yr[h*S+s] = gr*Hr[h*S+s] - gi*Hi[h*S+s];
+            Yi[h*S+s] = gr*Hi[h*S+s] + gi*Hr[h*S+s];
+        }
+    }
+    
+    // Start from single-scenario solution if available, else flat start
+    if(!hasSolution)
+        flatStart();
+    std::vector<double> Vr(4*numPoles*S), Vi(4*numPoles*S);
+    std::vector<double> Ir(4*numPoles*S), Ii(4*numPoles*S);
+    for(int n=0; n<4*numPoles; n++) {
+        for(int s=0; s<S; s++) {
+            Vr[n*S+s] = V[n].real();
+            Vi[n*S+s] = V[n].imag();
+        }
+    }
+    
+    double *vr, *vi, *ir, *ii, *pr, *pi, *yr, *yi;
+    double ar, ai;
+    for(iterations=1; iterations<=maxIterations; iterations++) {
+        
+        // Backward sweep
+        std::fill(Ir.begin(), Ir.end(), 0.0);
+        std::fill(Ii.begin(), Ii.end(), 0.0);
+        for(int h=0; h<numHouses; h++) {
+            pole = network.housePole[h];
+            phase = network.housePhase[h];
+            if(phase < 0 || phase > 2)
+                continue;
+            vr = &Vr[(4*pole+phase)*S];  vi = &Vi[(4*pole+phase)*S];
+            pr = &Vr[(4*pole+3)*S];      pi = &Vi[(4*pole+3)*S];
+            yr = &Yr[h*S];               yi = &Yi[h*S];
+            ir = &Ir[(4*pole+phase)*S];  ii = &Ii[(4*pole+phase)*S];
+            for(int s=0; s<S; s++) {
+                ar = yr[s]*(vr[s]-pr[s]) - yi[s]*(vi[s]-pi[s]);
+                ai = yr[s]*(vi[s]-pi[s]) + yi[s]*(vr[s]-pr[s]);
+                ir[s] += ar;
+                ii[s] += ai;
+            }
+            ir = &Ir[(4*pole+3)*S];      ii = &Ii[(4*pole+3)*S];
+            for(int s=0; s<S; s++) {
+                ir[s] -= yr[s]*(vr[s]-pr[s]) - yi[s]*(vi[s]-pi[s]);
+                ii[s] -= yr[s]*(vi[s]-pi[s]) + yi[s]*(vr[s]-pr[s]);
+            }
+        }
+        for(int i=numPoles-1; i>0; i--) {
+            ir = &Ir[4*network.parent[i]*S];  ii = &Ii[4*network.parent[i]*S];
+            pr = &Ir[4*i*S];                  pi = &Ii[4*i*S];
+            for(int n=0; n<4*S; n++) {
+                ir[n] += pr[n];
+                ii[n] += pi[n];
+            }
+        }
+        
+        // Forward sweep
+        maxChange = 0;
+        for(int i=1; i<numPoles; i++) {
+            zr = segmentZ[i].real();
+            zi = segmentZ[i].imag();
+            vr = &Vr[4*i*S];                  vi = &Vi[4*i*S];
+            pr = &Vr[4*network.parent[i]*S];  pi = &Vi[4*network.parent[i]*S];
+            ir = &Ir[4*i*S];                  ii = &Ii[4*i*S];
+            for(int n=0; n<4*S; n++) {
+                ar = pr[n] - (zr*ir[n] - zi*ii[n]);
+                ai = pi[n] - (zr*ii[n] + zi*ir[n]);
+                dr = ar - vr[n];
+                di = ai - vi[n];
+                maxChange = std::max(maxChange, dr*dr + di*di);
+                vr[n] = ar;
+                vi[n] = ai;
+            }
+        }
+        
+        if(maxChange < tolerance*tolerance)
+            break;
+    }
+    
+    if(iterations > maxIterations)
+        std::cout << " (WARNING: batch load flow did not converge after " 
+                  << maxIterations << " iterations)";
+    
+    // Household voltages
+    for(int h=0; h<numHouses; h++) {
+        pole = network.housePole[h];
+        phase = network.housePhase[h];
+        for(int s=0; s<S; s++) {
+            if(phase < 0 || phase > 2) {
+                houseV[s*numHouses+h] = 0;
+                continue;
+            }
+            ar = Vr[(4*pole+phase)*S+s] - Vr[(4*pole+3)*S+s];
+            ai = Vi[(4*pole+phase)*S+s] - Vi[(4*pole+3)*S+s];
+            dr = ar*Hr[h*S+s] - ai*Hi[h*S+s];
+            di = ar*Hi[h*S+s] + ai*Hr[h*S+s];
+            houseV[s*numHouses+h] = std::sqrt(dr*dr + di*di);
+        }
+    }
+    
+    return true;
+}
+
+double* NativeInterface::getVar(std::string var) {
+    std::cout << "Warning: variable " << var << " is not available from native load flow solver" << std::endl;
+    return NULL;
+}
+
+void NativeInterface::setVar(std::string component, double value, std::string var) {
+    std::cout << "Warning: cannot set " << var << " of " << component 
+              << " in native load flow solver, ignored" << std::endl;
+}
+
+void NativeInterface::setVar(std::string component, std::string value, std::string var){
+    std::cout << "Warning: cannot set " << var << " of " << component 
+              << " in native load flow solver, ignored" << std::endl;
+}
+
+void NativeInterface::setTxCapacity(std::string component, double value) {
+}
+
+int NativeInterface::getNumHouses() {
+    return network.numHouses;
+}
+
+std::vector <std::string> NativeInterface::getHouseNames() {
+    std::vector<std::string> houseNames;
+    for(int i=0; i<network.numHouses; i++)
+        houseNames.push_back(network.houses.at(i)->componentName);
+    return houseNames;
+}
+
+void NativeInterface::addVehicle(Vehicle vehicle) {
+    // Vehicle is connected in parallel to house load within same subsystem
+    int lastindex = vehicle.componentName.find_last_of("/");
+    std::string houseComponentName = vehicle.componentName.substr(0,lastindex).append("/House");
+    int house = componentHouse[findComponent(houseComponentName)];
+    
+    componentIndex[vehicle.componentName] = componentS.size();
+    componentS.push_back(std::complex<double>(0,0));
+    componentHouse.push_back(house);
+    houseComponents[house].push_back(componentS.size()-1);
+}
+
+void NativeInterface::setDemand(std::string component, double active, double inductive, double capacitive) {
+    // Capacitive power is stored as negative reactive power
+    componentS[findComponent(component)] = std::complex<double>(active, inductive + capacitive);
+}
+
+void NativeInterface::setDemand(std::string filename) {
+    std::ifstream infile(filename.c_str());
+    if(!infile.is_open()) {
+        std::cout << "Error: could not open load file " << filename << std::endl;
+        exit(1);
+    }
+    
+    // Each line has: componentName, active, inductive, capacitive
+    std::string line, component, a, i, c;
+    while(getline(infile, line)) {
+        if(line.length() == 0)
+            continue;
+        std::stringstream lineStream(line);
+        getline(lineStream, component, ',');
+        getline(lineStream, a, ',');
+        getline(lineStream, i, ',');
+        getline(lineStream, c, ',');
+        setDemand(component, utility::string2double(a), 
+                             utility::string2double(i), 
+                             utility::string2double(c));
+    }
+    infile.close();
+}
+
+void NativeInterface::setDemandComponents(std::vector<std::string> components) {
+    demandComponents.clear();
+    for(int i=0; i<components.size(); i++)
+        demandComponents.push_back(findComponent(components.at(i)));
+}
+
+void NativeInterface::setDemand(double* active, double* inductive, double* capacitive, int numLoads) {
+    if(numLoads != demandComponents.size()) {
+        std::cout << "Error: demand components not set, or number of loads (" 
+                  << numLoads << ") does not match" << std::endl;
+        exit(1);
+    }
+    
+    // Capacitive power is stored as negative reactive power
+    for(int i=0; i<numLoads; i++)
+        componentS[demandComponents[i]] = std::complex<double>(active[i], inductive[i] + capacitive[i]);
+}
+
+void NativeInterface::printModel(std::string targetDir) {
+    std::cout << " - Printing grid model to file ... ";
+    std::cout.flush();
+    
+    std::ofstream outfile((targetDir + "nativeModel.txt").c_str());
+    outfile << "Native load flow model: " << network.numPoles << " poles, " 
+            << network.numHouses << " houses" << std::endl
+            << "Source voltage (V): " << std::abs(sourceV[0]) << std::endl
+            << "End of line pole: " << network.poles[eolIndex]->name << std::endl
+            << std::endl;
+    
+    // Poles in breadth-first order, with impedance of line to their parent
+    // and (once solved) RMS voltage of phases A, B, C and neutral
+    outfile << "Pole, Parent, Line segment, R (Ohm), X (Ohm), V_A, V_B, V_C, V_N" << std::endl;
+    for(int i=0; i<network.numPoles; i++) {
+        outfile << network.poles[i]->name << ", ";
+        if(network.parent[i] < 0)
+            outfile << "-, -, 0, 0, ";
+        else
+            outfile << network.poles[network.parent[i]]->name << ", " 
+                    << network.segments[i]->name << ", "
+                    << segmentZ[i].real() << ", " << segmentZ[i].imag() << ", ";
+        for(int p=0; p<4; p++) {
+            if(hasSolution)
+                outfile << std::abs(V[4*i+p]);
+            else
+                outfile << "-";
+            outfile << (p < 3 ? ", " : "");
+        }
+        outfile << std::endl;
+    }
+    outfile << std::endl;
+    
+    // Households, with impedance of their service line and last load
+    outfile << "House, Pole, Phase, R (Ohm), X (Ohm), P (W), Q (VAr)" << std::endl;
+    for(int h=0; h<network.numHouses; h++)
+        outfile << network.houses[h]->name << ", "
+                << network.poles[network.housePole[h]]->name << ", "
+                << network.housePhase[h] << ", "
+                << houseServiceZ[h].real() << ", " << houseServiceZ[h].imag() << ", "
+                << houseS[h].real() << ", " << houseS[h].imag() << std::endl;
+    outfile.close();
+    
+    std::cout << "OK" << std::endl;
+}
+
+void NativeInterface::generateReport(std::string dir, int month, bool isWeekday, int simInterval) {
+    std::cout << "Warning: report generation is not supported by native load flow solver "
+              << "(plot logs with the MATLAB scripts instead)" << std::endl;
+}
+
+void NativeInterface::getOutputs(std::string logDir,
+                                NetworkData &networkData, 
+                                std::map<std::string,Household*> &households, 
+                                std::map<std::string,FeederLineSegment*> &lineSegments,
+                                std::map<std::string,FeederPole*> &poles) {
+    
+    // Voltages and currents at transformer.  Current into the network is
+    // the root's own current (which by now includes all downstream currents).
+    for(int p=0; p<4; p++) {
+        storePhasor(V[p], &networkData.phaseV[3*p]);
+        storePhasor(I[p], &networkData.phaseI[3*p]);
+        storePhasor(V[4*eolIndex+p], &networkData.eolV[3*p]);
+    }
+    networkData.iterations = numIterations;
+    
+    // Household voltages:  pole voltage less drop across service line
+    std::complex<double> houseV;
+    int pole, phase;
+    for(int h=0; h<network.numHouses; h++) {
+        pole = network.housePole[h];
+        phase = network.housePhase[h];
+        if(phase < 0 || phase > 2)
+            continue;
+        houseV = V[4*pole+phase] - V[4*pole+3] - 2.0*houseServiceZ[h]*houseI[h];
+        network.houses[h]->V_RMS = std::abs(houseV);
+        network.houses[h]->V_Mag = std::abs(houseV) * std::sqrt(2.0);
+        network.houses[h]->V_Pha = std::arg(houseV) * 180/M_PI;
+    }
+    
+    // Pole voltages and currents
+    for(int i=0; i<network.numPoles; i++) {
+        for(int p=0; p<3; p++) {
+            network.poles[i]->voltage[p] = toPhasor(V[4*i+p]);
+            network.poles[i]->current[p] = toPhasor(I[4*i+p]);
+        }
+    }
+    
+    // Voltage unbalance at end of each backbone line segment.  No unbalance 
+    // at root (transformer as a voltage source assumption).
+    Phasor V_ab, V_bc, V_ca;
+    Phasor v0, v1, v2;
+    double unbalance;
+    FeederPole* childPole;
+    int i;
+    for(i=1; i<network.numPoles; i++) {
+        childPole = network.poles[i];
+        V_ab = toPhasor(V[4*i+0] - V[4*i+1]);
+        V_bc = toPhasor(V[4*i+1] - V[4*i+2]);
+        V_ca = toPhasor(V[4*i+2] - V[4*i+0]);
+        
+        unbalance = power::calculatePhaseUnbalance(V_ab, V_bc, V_ca);
+        power::symmetricalComponents(V_ab, V_bc, V_ca, v0, v1, v2);
+        
+        childPole->parentLineSegment->voltageUnbalance = unbalance;
+        for(std::vector<Household*>::iterator it = childPole->households.begin(); it != childPole->households.end(); ++it) {
+            (*it)->V_unbalance = unbalance;
+            (*it)->V_0 = v0.getAmplitude();
+            (*it)->V_1 = v1.getAmplitude();
+            (*it)->V_2 = v2.getAmplitude();
+        }
+    }
+}
+
+// Write vector of complex values, preceded by its size
+static void writeComplex(std::ostream &out, std::vector< std::complex<double> > &values) {
+    utility::writeBinary(out, (int)values.size());
+    for(int i=0; i<values.size(); i++)
+        utility::writeBinary(out, values[i]);
+}
+
+// Read vector of complex values written by writeComplex
+static void readComplex(std::istream &in, std::vector< std::complex<double> > &values) {
+    int size = 0;
+    utility::readBinary(in, size);
+    values.resize(size);
+    for(int i=0; i<size; i++)
+        utility::readBinary(in, values[i]);
+}
+
+void NativeInterface::saveState(std::ostream &out) {
+    utility::writeBinary(out, hasSolution);
+    writeComplex(out, V);
+    writeComplex(out, I);
+    writeComplex(out, houseI);
+    writeComplex(out, houseS);
+    writeComplex(out, componentS);
+}
+
+void NativeInterface::loadState(std::istream &in) {
+    utility::readBinary(in, hasSolution);
+    readComplex(in, V);
+    readComplex(in, I);
+    readComplex(in, houseI);
+    readComplex(in, houseS);
+    readComplex(in, componentS);
+}
+
+void NativeInterface::flatStart() {
+    V.assign(4*network.numPoles, std::complex<double>(0,0));
+    for(int i=0; i<network.numPoles; i++)
+        for(int p=0; p<3; p++)
+            V[4*i+p] = sourceV[p];
+    I.assign(4*network.numPoles, std::complex<double>(0,0));
+    houseI.assign(network.numHouses, std::complex<double>(0,0));
+    hasSolution = false;
+}
+
+int NativeInterface::findComponent(std::string component) {
+    std::map<std::string, int>::iterator it = componentIndex.find(component);
+    if(it == componentIndex.end()) {
+        std::cout << "Error: unknown component " << component << std::endl;
+        exit(1);
+    }
+    return it->second;
+}
+
+void NativeInterface::storePhasor(std::complex<double> v, double* out) {
+    out[0] = std::abs(v);
+    out[1] = std::abs(v) * std::sqrt(2.0);
+    out[2] = std::arg(v) * 180/M_PI;
+}
+
+Phasor NativeInterface::toPhasor(std::complex<double> v) {
+    Phasor phasor;
+    phasor.set(std::abs(v) * std::sqrt(2.0), std::arg(v) * 180/M_PI);
+    return phasor;
+}
@@ -0,0 +1,269 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef NATIVEINTERFACE_H
+#define	NATIVEINTERFACE_H
+
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <complex>
+#include <cmath>
+#include <algorithm>
+
+#include "LoadFlowInterface.h"
+#include "ModelFileParser.h"
+#include "../utility/Utility.h"
+#include "../utility/Power.h"
+#include "../gridmodel/CompiledNetwork.h"
+
+
+/** A load flow interface that solves the radial distribution feeder directly
+  * within POSSIM, using a three-phase (plus neutral) backward/forward sweep.
+  * The network structure is read from the same model file used by the MATLAB
+  * interface, so no MATLAB installation is required.
+  * 
+  * Modelling assumptions:
+  *  - The transformer is an ideal, balanced voltage source at the root pole
+  *    with a solidly grounded neutral.
+  *  - Line segments are series impedances R + jwL per phase conductor, with
+  *    the neutral conductor having the same impedance.  Shunt capacitance
+  *    and mutual coupling between conductors are ignored.
+  *  - Households (and vehicles) are constant impedance loads, as in the
+  *    MATLAB model, dimensioned at the network's base voltage.  Each house is
+  *    connected phase-to-neutral through its service line (active and 
+  *    neutral conductor). */
+class NativeInterface : public LoadFlowInterface {
+    
+private:
+    /** Local pointer to config */
+    Config *config;
+    
+    /** Network frequency (Hz). */
+    double frequency;
+    
+    /** Voltage at which household loads are specified (V). */
+    double baseVoltage;
+    
+    /** Convergence tolerance: largest change in any node voltage between
+      * two successive iterations (V). */
+    double tolerance;
+    
+    /** Maximum number of sweeps before giving up on convergence. */
+    int maxIterations;
+    
+    /** Number of sweeps taken by the last load flow calculation. */
+    int numIterations;
+    
+    /** If true, each load flow starts from the previous solution rather 
+      * than from a flat (source voltage everywhere) start. */
+    bool warmStart;
+    
+    /** Name of network model without extension. */
+    std::string modelNameRoot;
+    
+    /** Parser of network model file, possibly shared with other instances
+      * so the file is only read once. */
+    ModelFileParser* parser;
+    
+    /** True if parser was created by (and is deleted with) this instance. */
+    bool ownsParser;
+    
+    /** Source voltage (phase to neutral, RMS) of each phase at the transformer. */
+    std::complex<double> sourceV[3];
+    
+    /** Flattened network, poles in breadth-first order from the root. */
+    CompiledNetwork network;
+    
+    /** For each pole, series impedance of the line segment 
+      * connecting it to its parent. */
+    std::vector< std::complex<double> > segmentZ;
+    
+    /** Index of the pole furthest (by impedance) from the
+      * transformer.  Used for end-of-line measurements. */
+    int eolIndex;
+    
+    /** For each household, impedance of a single service line conductor. */
+    std::vector< std::complex<double> > houseServiceZ;
+    
+    /** For each household, the total load (including vehicles) as complex
+      * power: P + jQ. */
+    std::vector< std::complex<double> > houseS;
+    
+    /** Index of each component (households and vehicles), mapped to the
+      * component's name. */
+    std::map<std::string, int> componentIndex;
+    
+    /** Load of each component as complex power: P + jQ. */
+    std::vector< std::complex<double> > componentS;
+    
+    /** Index of household that each component belongs to. */
+    std::vector<int> componentHouse;
+    
+    /** Component index of each load passed to bulk setDemand, in order. */
+    std::vector<int> demandComponents;
+    
+    /** Node voltages of each pole: phases A, B, C and neutral. */
+    std::vector< std::complex<double> > V;
+    
+    /** Current flowing into each pole from its parent: phases A, B, C and neutral. */
+    std::vector< std::complex<double> > I;
+    
+    /** Current drawn by each household's load (including vehicles). */
+    std::vector< std::complex<double> > houseI;
+    
+    /** Components belonging to each household. */
+    std::vector< std::vector<int> > houseComponents;
+    
+    /** True once a full load flow solution is available. */
+    bool hasSolution;
+    
+    /** Scratch space for incremental updates: change in current into each
+      * pole, and change in voltage at each pole (phases A, B, C, neutral). */
+    std::vector< std::complex<double> > deltaI, deltaV;
+    
+public:
+    /** Constructor */
+    NativeInterface(Config* config);
+    
+    /** Constructor.  Network model is taken from the given parser, which may 
+      * already have parsed it for another instance. */
+    NativeInterface(Config* config, ModelFileParser* parser);
+    
+    /** Destructor */
+    ~NativeInterface();
+
+    /** Nothing to do, network model is read in extractModel. */
+    void loadModel(Config* config);
+    
+    /** Parse the model file, build the network tree, and prepare the flattened
+      * network representation used by the solver. */
+    void extractModel(FeederPole* &root, 
+                      DistributionTransformer* &transformer,
+                      std::map<std::string,FeederPole*> &poles, 
+                      std::map<std::string,FeederLineSegment*> &lineSegments, 
+                      std::map<std::string,Household*> &households);
+    
+    /** Run backward/forward sweep load flow calculation. */
+    void runSim();
+    
+    /** Update last solution for a change in the given loads only.  The
+      * change in each affected house's current (at the existing voltage) is
+      * added along the path from its pole to the root, and the resulting
+      * voltage drops are applied in a single pass.  Response of all other
+      * (constant impedance) loads to the voltage change is neglected. */
+    bool runIncrementalSim(std::vector<int> changedLoads);
+    
+    /** Solve all scenarios in a single set of sweeps.  All arrays are laid
+      * out with the scenario as the innermost (contiguous) index, and complex
+      * quantities are split into real and imaginary arrays, so that the inner
+      * loops over scenarios can be vectorised by the compiler. */
+    bool runBatchSim(int numScenarios, double* active, double* inductive, 
+                     double* capacitive, double* houseV);
+    
+    /** Not supported (warns, returns NULL). */
+    double* getVar(std::string var);
+    
+    /** Not supported (warns). */
+    void setVar(std::string component, double value, std::string var);
+    
+    /** Not supported (warns). */
+    void setVar(std::string component, std::string value, std::string var);
+    
+    /** Transformer is modelled as ideal, so capacity has no effect on load flow. */
+    void setTxCapacity(std::string component, double value);
+    
+    /** Get number of houses */
+    int getNumHouses();
+    
+    /** Get house names */
+    std::vector <std::string> getHouseNames();
+    
+    /** Add vehicle as an additional load at its household. */
+    void addVehicle(Vehicle vehicle);
+    
+    /** Set demand of given component. */
+    void setDemand(std::string component, double a, double i, double c);
+    
+    /** Set demand of components specified in given file. */
+    void setDemand(std::string filename);
+    
+    /** Resolve names of components whose demand is set in bulk. */
+    void setDemandComponents(std::vector<std::string> components);
+    
+    /** Set demand of all components given to setDemandComponents. */
+    void setDemand(double* active, double* inductive, double* capacitive, int numLoads);
+    
+    /** Write network (poles, line and service impedances, houses) and, once
+      * solved, pole voltages to nativeModel.txt in given directory. */
+    void printModel(std::string targetDir);
+    
+    /** Not supported (warns). */
+    void generateReport(std::string dir, int month, bool isWeekday, int simInterval);
+    
+    /** Get load flow output following load flow calculation. */
+    void getOutputs(std::string logDir,
+                                NetworkData &networkData, 
+                                std::map<std::string,Household*> &households, 
+                                std::map<std::string,FeederLineSegment*> &lineSegments,
+                                std::map<std::string,FeederPole*> &poles);
+    
+    /** Write previous solution (starting point of next load flow) to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read previous solution from checkpoint. */
+    void loadState(std::istream &in);
+    
+private:
+    /** Read solver settings from config (common to both constructors). */
+    void initialise();
+    
+    /** Set all pole voltages to the source voltage, currents to zero. */
+    void flatStart();
+    
+    /** Find index of component having given name; exits if there is none. */
+    int findComponent(std::string component);
+    
+    /** Store the given phasor (RMS internally) as RMS, peak magnitude, and
+      * phase in degrees, in the given array. */
+    void storePhasor(std::complex<double> v, double* out);
+    
+    /** Convert to POSSIM phasor (peak magnitude). */
+    Phasor toPhasor(std::complex<double> v);
+};
+
+#endif	/* NATIVEINTERFACE_H */
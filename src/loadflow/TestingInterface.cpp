@@ -61,6 +61,15 @@ void TestingInterface::extractModel(FeederPole* &root,
 void TestingInterface::runSim() {
 }
 
+bool TestingInterface::runIncrementalSim(std::vector<int> changedLoads) {
+    return false;
+}
+
+bool TestingInterface::runBatchSim(int numScenarios, double* active, double* inductive, 
+                                   double* capacitive, double* houseV) {
+    return false;
+}
+
 double* TestingInterface::getVar(std::string var) {
     return NULL;
 }
@@ -97,6 +106,12 @@ void TestingInterface::setDemand(std::string component, double a, double i, doub
 void TestingInterface::setDemand(std::string filename) {
 }
 
+void TestingInterface::setDemandComponents(std::vector<std::string> components) {
+}
+
+void TestingInterface::setDemand(double* active, double* inductive, double* capacitive, int numLoads) {
+}
+
 void TestingInterface::printModel(std::string targetDir) {
 }
 
@@ -109,5 +124,11 @@ void TestingInterface::getOutputs(std::string logDir,
                                 std::map<std::string,Household*> &households, 
                                 std::map<std::string,FeederLineSegment*> &lineSegments,
                                 std::map<std::string,FeederPole*> &poles) {
-    
+    networkData.iterations = 0;
+}
+
+void TestingInterface::saveState(std::ostream &out) {
+}
+
+void TestingInterface::loadState(std::istream &in) {
 }
@@ -67,6 +67,9 @@ public:
                       std::map<std::string,FeederLineSegment*> &lineSegments, 
                       std::map<std::string,Household*> &households);
     void runSim();
+    bool runIncrementalSim(std::vector<int> changedLoads);
+    bool runBatchSim(int numScenarios, double* active, double* inductive, 
+                     double* capacitive, double* houseV);
     double* getVar(std::string var);
     void setVar(std::string component, double value, std::string var);
     void setVar(std::string component, std::string value, std::string var);
@@ -76,6 +79,8 @@ public:
     void addVehicle(Vehicle vehicle);
     void setDemand(std::string component, double a, double i, double c);
     void setDemand(std::string filename);
+    void setDemandComponents(std::vector<std::string> components);
+    void setDemand(double* active, double* inductive, double* capacitive, int numLoads);
     void printModel(std::string targetDir);
     void generateReport(std::string dir, int month, bool isWeekday, int simInterval);
     void getOutputs(std::string logDir,
@@ -83,6 +88,8 @@ public:
                                 std::map<std::string,Household*> &households, 
                                 std::map<std::string,FeederLineSegment*> &lineSegments,
                                 std::map<std::string,FeederPole*> &poles);
+    void saveState(std::ostream &out);
+    void loadState(std::istream &in);
 };
 #endif	/* TESTINGINTERFACE_H */
 
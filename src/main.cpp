@@ -38,7 +38,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <stdio.h>
 
 #include "simulator/Simulator.h"
+#include "simulator/Ensemble.h"
 #include "simulator/Config.h"
+#include "utility/Profiler.h"
 #include "../cmake/POSSIMConfig.h"
 
 // Please leave the below comment for doxygen documentation
@@ -87,8 +89,28 @@ int main(int argc, char ** argv)
         std::cout << std::endl;
     }
     
-    Simulator sim(config);
-    sim.run();
+    // Optionally, time zones of the code (and record them as trace events)
+    if(config->getString("profile") == "yes" || config->getString("profile") == "trace")
+        Profiler::enable(config->getString("profile") == "trace", config->getInt("profileevents"));
+    
+    // Either a whole ensemble of simulations, or just one
+    std::string logDir;
+    if(config->getInt("ensemblesize") > 1) {
+        Ensemble ensemble(config);
+        ensemble.run();
+        logDir = ensemble.getDir();
+    }
+    else {
+        Simulator sim(config);
+        sim.run();
+        logDir = sim.getLogDir();
+    }
+    
+    if(Profiler::isEnabled()) {
+        Profiler::display();
+        Profiler::write(logDir);
+        std::cout << "Profile written to " << logDir << std::endl;
+    }
     
     return 0;
 }
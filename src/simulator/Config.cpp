@@ -103,6 +103,10 @@ void Config::correctValues() {
             value.compare("digsilent") == 0 ||
             value.compare("2") == 0)
                setConfigVar("loadflowsimulator", "digsilent");
+    else if(value.compare("Native") == 0 ||
+            value.compare("native") == 0 ||
+            value.compare("3") == 0)
+               setConfigVar("loadflowsimulator", "native");
     
     value = getConfigVar("chargingalgorithm");
     if(value.compare("Uncontrolled") == 0 ||
@@ -203,6 +207,8 @@ int Config::getLoadFlowSim() {
                return 1;
     else if(value.compare("digsilent") == 0)
                return 2;
+    else if(value.compare("native") == 0)
+               return 3;
     
     return 1;
 }
@@ -0,0 +1,183 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "Ensemble.h"
+
+Ensemble::Ensemble(Config* configIn):
+        householdDemandModel(configIn),
+        trafficModel(configIn),
+        parser(configIn)
+{
+    config = configIn;
+    ensembleSize = config->getInt("ensemblesize");
+    numThreads = config->getInt("ensemblethreads");
+    if(numThreads <= 0)
+        numThreads = boost::thread::hardware_concurrency();
+    numThreads = std::max(1, std::min(numThreads, ensembleSize));
+    nextMember = 0;
+    
+    // Members run side by side, which only the native solver supports
+    if(config->getLoadFlowSim() != 3) {
+        std::cout << "Error: ensemble runs require the native load flow solver (-l native)" << std::endl;
+        exit(1);
+    }
+    
+    // All members are seeded from a master seed
+    unsigned int masterSeed = config->getInt("randomseed");
+    if(masterSeed == 0)
+        masterSeed = (unsigned int)time(NULL);
+    
+    std::cout << "Preparing ensemble of " << ensembleSize << " simulations (master seed " 
+              << masterSeed << ") ..." << std::endl;
+    
+    Logging log;
+    log.createDir();
+    directory = log.getDir();
+    
+    // Members themselves are only loaded just before they run
+    std::stringstream ss;
+    for(int i=0; i<ensembleSize; i++) {
+        ss.str("");
+        ss << directory << "member_" << std::setw(3) << std::setfill('0') << i+1 << "/";
+        memberDirs.push_back(ss.str());
+        seeds.push_back((unsigned int)RandomStream(masterSeed, "ensemble", i+1).next());
+    }
+    summaries.resize(ensembleSize);
+    
+    std::cout << " - Ensemble prepared OK" << std::endl << std::endl;
+}
+
+Ensemble::~Ensemble() {
+}
+
+void Ensemble::run() {
+    boost::posix_time::ptime timer;
+    utility::startTimer(timer);
+    
+    std::cout << "Running ensemble on " << numThreads << " thread(s) ..." << std::endl;
+    
+    boost::thread_group threads;
+    for(int i=0; i<numThreads; i++)
+        threads.create_thread(boost::bind(&Ensemble::runMembers, this));
+    threads.join_all();
+    
+    std::cout << "-------------------------------------------" << std::endl
+              << "Ensemble complete, took " << utility::endTimer(timer) << std::endl;
+    writeSummary();
+    std::cout << "Summary written to " << directory << std::endl;
+    std::cout << "-------------------------------------------" << std::endl; 
+}
+
+std::string Ensemble::getDir() {
+    return directory;
+}
+
+void Ensemble::runMembers() {
+    int i;
+    Simulator* member;
+    while(true) {
+        // Members are loaded one after the other (loading reads the shared
+        // models and config), only running them is parallel
+        {
+            boost::mutex::scoped_lock lock(memberMutex);
+            i = nextMember++;
+            if(i >= ensembleSize)
+                return;
+            member = new Simulator(config, householdDemandModel, trafficModel, &parser, memberDirs[i], seeds[i]);
+        }
+        
+        member->run();
+        summaries[i] = member->getSummary();
+        delete member;
+    }
+}
+
+void Ensemble::writeSummary() {
+    const int numStats = 6;
+    std::string names[numStats] = {"Min V", "Max V", "Under-voltage count", "Peak demand (W)", 
+                                   "Vehicle energy (kWh)", "Max V unbalance (%)"};
+    std::vector< std::vector<double> > stats(ensembleSize, std::vector<double>(numStats));
+    for(int i=0; i<ensembleSize; i++) {
+        stats[i][0] = summaries[i].minHouseholdV;
+        stats[i][1] = summaries[i].maxHouseholdV;
+        stats[i][2] = summaries[i].numUnderVoltage;
+        stats[i][3] = summaries[i].peakDemand;
+        stats[i][4] = summaries[i].vehicleEnergy;
+        stats[i][5] = summaries[i].maxVoltageUnbalance;
+    }
+    
+    std::ofstream outfile((directory + "ensemble_summary.csv").c_str());
+    outfile << "Member, Seed, ";
+    for(int j=0; j<numStats; j++)
+        outfile << names[j] << ", ";
+    outfile << std::endl;
+    for(int i=0; i<ensembleSize; i++) {
+        outfile << i+1 << ", " << seeds[i] << ", ";
+        for(int j=0; j<numStats; j++)
+            outfile << stats[i][j] << ", ";
+        outfile << std::endl;
+    }
+    
+    // Statistics across members
+    std::vector<double> mean(numStats, 0), stdDev(numStats, 0), min(numStats, 1e300), max(numStats, -1e300);
+    for(int j=0; j<numStats; j++) {
+        for(int i=0; i<ensembleSize; i++) {
+            mean[j] += stats[i][j]/ensembleSize;
+            min[j] = std::min(min[j], stats[i][j]);
+            max[j] = std::max(max[j], stats[i][j]);
+        }
+        for(int i=0; i<ensembleSize; i++)
+            stdDev[j] += (stats[i][j]-mean[j])*(stats[i][j]-mean[j]);
+        stdDev[j] = std::sqrt(stdDev[j]/std::max(1, ensembleSize-1));
+    }
+    
+    std::string rowNames[4] = {"Mean", "Std dev", "Min", "Max"};
+    std::vector<double>* rows[4] = {&mean, &stdDev, &min, &max};
+    for(int r=0; r<4; r++) {
+        outfile << rowNames[r] << ", , ";
+        for(int j=0; j<numStats; j++)
+            outfile << (*rows[r])[j] << ", ";
+        outfile << std::endl;
+    }
+    outfile.close();
+    
+    std::cout << "Ensemble Summary (" << ensembleSize << " members)" << std::endl
+              << std::setiosflags(std::ios::fixed) << std::setprecision(2);
+    for(int j=0; j<numStats; j++)
+        std::cout << "  " << std::setw(22) << std::left << names[j] 
+                  << ": mean " << std::setw(10) << mean[j]
+                  << " std dev " << std::setw(10) << stdDev[j]
+                  << " min " << std::setw(10) << min[j]
+                  << " max " << max[j] << std::endl;
+}
@@ -0,0 +1,119 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef ENSEMBLE_H
+#define	ENSEMBLE_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include "Config.h"
+#include "Simulator.h"
+#include "../loadflow/ModelFileParser.h"
+#include "../household/HouseholdDemandModel.h"
+#include "../vehicle/TrafficModel.h"
+
+
+/** Runs an ensemble of independent simulations (e.g. for Monte Carlo 
+  * analysis) side by side on a pool of threads.  Demand profiles, travel 
+  * records and the network model are read only once and shared by all
+  * members;  each member has its own random seed and writes its own log
+  * subdirectory.  Once all members are complete, summary statistics across
+  * the ensemble are written to the ensemble's log directory. */
+class Ensemble {
+private:
+    /** Local pointer to config object */
+    Config *config;
+    
+    /** Number of simulations in the ensemble */
+    int ensembleSize;
+    
+    /** Number of threads to run simulations on */
+    int numThreads;
+    
+    /** Household demand model, shared by all members */
+    HouseholdDemandModel householdDemandModel;
+    
+    /** Traffic model, whose travel records are shared by all members */
+    TrafficModel trafficModel;
+    
+    /** Parser of network model, shared by all members */
+    ModelFileParser parser;
+    
+    /** Log directory of each member */
+    std::vector<std::string> memberDirs;
+    
+    /** Random seed of each member */
+    std::vector<unsigned int> seeds;
+    
+    /** Summary statistics of each member, filled in as members complete */
+    std::vector<SimulationSummary> summaries;
+    
+    /** Directory containing log subdirectories of all members */
+    std::string directory;
+    
+    /** Index of next member to be run */
+    int nextMember;
+    
+    /** Guards nextMember, and loading of members */
+    boost::mutex memberMutex;
+    
+public:
+    /** Constructor.  Loads shared models, and seeds each member. */
+    Ensemble(Config* config);
+    
+    /** Destructor */
+    virtual ~Ensemble();
+    
+    /** Run all members, then write summary statistics. */
+    void run();
+    
+    /** Return the ensemble's log directory. */
+    std::string getDir();
+    
+private:
+    /** Worker thread:  load and run members, one at a time, until there are
+      * none left.  Each member is deleted once it has run. */
+    void runMembers();
+    
+    /** Write summary of each member, and statistics across members, to log. */
+    void writeSummary();
+};
+
+#endif	/* ENSEMBLE_H */
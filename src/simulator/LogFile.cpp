@@ -0,0 +1,226 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "LogFile.h"
+
+// Identifies binary log files, and version of their format
+static const char LOGFILE_ID[8] = {'P','O','S','S','I','M','L','G'};
+static const int LOGFILE_VERSION = 1;
+
+
+LogFile::LogFile(std::string file, Format f, ColumnType t, bool gzip, bool trailing, int columns, int rows) {
+    fileName = file;
+    format = f;
+    type = t;
+    compressed = gzip;
+    trailingSeparator = trailing;
+    numColumns = columns;
+    chunkSize = rows;
+    chunkRows = 0;
+}
+
+LogFile::~LogFile() {
+    flush();
+}
+
+void LogFile::create(std::string header) {
+    open(true);
+    
+    if(format == CSV)
+        stream << header;
+    
+    else {
+        stream.write(LOGFILE_ID, sizeof(LOGFILE_ID));
+        utility::writeBinary(stream, LOGFILE_VERSION);
+        utility::writeBinary(stream, (int)type);
+        utility::writeBinary(stream, (int)trailingSeparator);
+        utility::writeBinary(stream, numColumns);
+        utility::writeBinary(stream, header);
+    }
+    stream.reset();
+}
+
+void LogFile::open(bool replace) {
+    std::ios::openmode mode = replace ? std::ios::trunc : std::ios::app;
+    if(compressed || format == Binary)
+        mode |= std::ios::binary;
+    
+    if(compressed)
+        stream.push(boost::iostreams::gzip_compressor());
+    stream.push(boost::iostreams::file_sink(fileName, mode));
+}
+
+void LogFile::append(DateTime &time, std::vector<double> &values) {
+    append(time, values.empty() ? NULL : &values[0]);
+}
+
+void LogFile::append(DateTime &time, const double* values) {
+    if(stream.empty())
+        open(false);
+    
+    if(format == CSV) {
+        stream << time.toString();
+        for(int i=0; i<numColumns; i++) {
+            stream << ", ";
+            writeCSVValue(stream, values[i], type);
+        }
+        if(trailingSeparator)
+            stream << ", ";
+        stream << "\n";
+        return;
+    }
+    
+    // Binary:  collect rows, stored column by column once chunk is full
+    if(chunkRows == 0) {
+        chunkDates.resize(chunkSize);
+        chunkMinutes.resize(chunkSize);
+        chunkValues.resize(chunkSize * numColumns);
+    }
+    chunkDates[chunkRows] = time.year*10000 + time.month*100 + time.day;
+    chunkMinutes[chunkRows] = time.totalMinutes();
+    for(int i=0; i<numColumns; i++)
+        chunkValues[i*chunkSize + chunkRows] = values[i];
+    chunkRows++;
+    
+    if(chunkRows == chunkSize)
+        writeChunk();
+}
+
+void LogFile::flush() {
+    if(stream.empty())
+        return;
+    if(chunkRows > 0)
+        writeChunk();
+    stream.reset();
+}
+
+void LogFile::writeChunk() {
+    utility::writeBinary(stream, chunkRows);
+    stream.write((char*)&chunkDates[0], chunkRows*sizeof(int));
+    stream.write((char*)&chunkMinutes[0], chunkRows*sizeof(int));
+    
+    for(int i=0; i<numColumns; i++) {
+        double* column = &chunkValues[i*chunkSize];
+        if(type == Float64)
+            stream.write((char*)column, chunkRows*sizeof(double));
+        else if(type == Float32)
+            for(int j=0; j<chunkRows; j++)
+                utility::writeBinary(stream, (float)column[j]);
+        else
+            for(int j=0; j<chunkRows; j++)
+                utility::writeBinary(stream, (int)column[j]);
+    }
+    chunkRows = 0;
+}
+
+void LogFile::writeCSVValue(std::ostream &out, double value, ColumnType type) {
+    if(type == Int32)
+        out << (long)value;
+    else
+        out << value;
+}
+
+bool LogFile::convertToCSV(std::string binaryFile, std::string csvFile) {
+    boost::iostreams::filtering_istream in;
+    if(boost::filesystem::path(binaryFile).extension().string() == ".gz")
+        in.push(boost::iostreams::gzip_decompressor());
+    in.push(boost::iostreams::file_source(binaryFile, std::ios::binary));
+    char id[sizeof(LOGFILE_ID)];
+    int version, columnType, trailing, columns, rows;
+    std::string header;
+    
+    in.read(id, sizeof(id));
+    utility::readBinary(in, version);
+    if(!in || !std::equal(id, id+sizeof(id), LOGFILE_ID) || version != LOGFILE_VERSION)
+        return false;
+    utility::readBinary(in, columnType);
+    utility::readBinary(in, trailing);
+    utility::readBinary(in, columns);
+    utility::readBinary(in, header);
+    
+    std::ofstream out(csvFile.c_str());
+    out << header;
+    
+    std::vector<int> dates, minutes;
+    std::vector<double> values;
+    DateTime time;
+    while(true) {
+        utility::readBinary(in, rows);
+        if(!in)
+            break;
+        
+        dates.resize(rows);
+        minutes.resize(rows);
+        values.resize(rows * columns);
+        in.read((char*)&dates[0], rows*sizeof(int));
+        in.read((char*)&minutes[0], rows*sizeof(int));
+        
+        for(int i=0; i<columns; i++) {
+            double* column = &values[i*rows];
+            if(columnType == Float64)
+                in.read((char*)column, rows*sizeof(double));
+            else if(columnType == Float32) {
+                float value;
+                for(int j=0; j<rows; j++) {
+                    utility::readBinary(in, value);
+                    column[j] = value;
+                }
+            }
+            else {
+                int value;
+                for(int j=0; j<rows; j++) {
+                    utility::readBinary(in, value);
+                    column[j] = value;
+                }
+            }
+        }
+        if(!in) {
+            std::cout << "Warning: " << binaryFile << " ends in an incomplete chunk" << std::endl;
+            break;
+        }
+        
+        for(int j=0; j<rows; j++) {
+            time.set(minutes[j]/60, minutes[j]%60, dates[j]%100, (dates[j]/100)%100, dates[j]/10000);
+            out << time.toString();
+            for(int i=0; i<columns; i++) {
+                out << ", ";
+                writeCSVValue(out, values[i*rows + j], (ColumnType)columnType);
+            }
+            if(trailing)
+                out << ", ";
+            out << "\n";
+        }
+    }
+    return true;
+}
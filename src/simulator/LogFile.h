@@ -0,0 +1,137 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef LOGFILE_H
+#define	LOGFILE_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/file.hpp>
+
+#include "../utility/Utility.h"
+#include "../utility/DateTime.h"
+
+
+/** A single log file, holding one row of values per sim interval.  Written
+  * either as CSV text, or in a binary columnar format that is much faster to
+  * write and read back.  Binary files consist of a header:
+  * 
+  *   "POSSIMLG", version, column type, trailing separator, number of 
+  *   columns, CSV header text
+  * 
+  * followed by chunks of rows, each holding the number of rows, the date 
+  * (yyyymmdd) and minute of day of each row, and then each column's values
+  * in turn.  convertToCSV turns a binary file into the equivalent CSV file.
+  * 
+  * Either format may be gzip compressed as it is written.  Compressed files
+  * consist of several gzip members (one per flush), which gunzip and zcat
+  * read as a single file. */
+class LogFile {
+    
+public:
+    /** Format of log files. */
+    enum Format {CSV, Binary};
+    
+    /** Type in which values are stored in binary files.  Values in Int32
+      * columns are written as integers in CSV files too. */
+    enum ColumnType {Float32, Float64, Int32};
+    
+private:
+    std::string fileName;
+    Format format;
+    ColumnType type;
+    
+    /** True if file is gzip compressed. */
+    bool compressed;
+    
+    /** True if every row ends in a separator (as most CSV logs do). */
+    bool trailingSeparator;
+    
+    int numColumns;
+    
+    /** Rows per chunk in binary files. */
+    int chunkSize;
+    
+    /** Stream, opened on first append and kept open until flushed. */
+    boost::iostreams::filtering_ostream stream;
+    
+    /** Rows not yet written to binary file:  dates, times, and values
+      * (one column after the other). */
+    std::vector<int> chunkDates;
+    std::vector<int> chunkMinutes;
+    std::vector<double> chunkValues;
+    int chunkRows;
+
+public:
+    /** Constructor.  File name should include extension. */
+    LogFile(std::string fileName, Format format, ColumnType type, bool compressed, bool trailingSeparator, int numColumns, int chunkSize);
+    
+    /** Destructor, writes any remaining rows. */
+    virtual ~LogFile();
+    
+    /** Create file (replacing any existing one), starting with given header
+      * (one or more complete CSV lines). */
+    void create(std::string header);
+    
+    /** Append one row of numColumns values. */
+    void append(DateTime &time, const double* values);
+    
+    /** Append one row of values. */
+    void append(DateTime &time, std::vector<double> &values);
+    
+    /** Write any pending rows and close stream (completing the current gzip
+      * member), so that file is complete up to here. */
+    void flush();
+    
+    /** Convert binary log file (gzip compressed if its name ends in .gz) to
+      * CSV.  Returns false if not a log file. */
+    static bool convertToCSV(std::string binaryFile, std::string csvFile);
+    
+private:
+    /** Open stream, either replacing or appending to file. */
+    void open(bool replace);
+    
+    /** Write pending rows of binary file as one chunk. */
+    void writeChunk();
+    
+    /** Write one value in CSV format. */
+    static void writeCSVValue(std::ostream &out, double value, ColumnType type);
+};
+
+#endif	/* LOGFILE_H */
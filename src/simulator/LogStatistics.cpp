@@ -0,0 +1,193 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "LogStatistics.h"
+#include "Logging.h"
+
+
+LogStatistics::LogStatistics(Config* config, const GridModel &gridModel) {
+    minVoltage = config->getInt("minvoltage");
+    simInterval = config->getInt("simulationinterval");
+    quantile = config->getDouble("statisticsquantile");
+    if(quantile <= 0 || quantile >= 1) {
+        std::cout << "Error: statistics quantile must be between 0 and 1" << std::endl;
+        exit(1);
+    }
+    
+    for(std::map<std::string,Household*>::const_iterator it = gridModel.households.begin(); it != gridModel.households.end(); ++it)
+        householdNames.push_back(it->first);
+    for(std::map<std::string,FeederLineSegment*>::const_iterator it = gridModel.lineSegments.begin(); it != gridModel.lineSegments.end(); ++it)
+        segmentNames.push_back(it->first);
+    for(std::map<std::string,Vehicle*>::const_iterator it = gridModel.vehicles.begin(); it != gridModel.vehicles.end(); ++it)
+        vehicleNames.push_back(it->first);
+    
+    householdV.resize(householdNames.size());
+    householdVQuantile.resize(householdNames.size(), P2Quantile(quantile));
+    householdUnderVoltage.resize(householdNames.size(), 0);
+    segmentUnbalance.resize(segmentNames.size());
+    networkQuantile.resize(6, P2Quantile(1-quantile));
+    vehicleEnergy.resize(vehicleNames.size(), 0);
+    vehicleSOC.resize(vehicleNames.size());
+    vehicleFinalSOC.resize(vehicleNames.size(), 0);
+}
+
+LogStatistics::~LogStatistics() {
+}
+
+void LogStatistics::update(LogSnapshot &snapshot) {
+    double totalDemand = 0;
+    
+    for(size_t i=0; i<householdV.size(); i++) {
+        double V = snapshot.householdV[3*i];
+        householdV[i].add(V);
+        householdVQuantile[i].add(V);
+        if(V < minVoltage)
+            householdUnderVoltage[i]++;
+        totalDemand += snapshot.householdP[i];
+    }
+    
+    for(size_t i=0; i<segmentUnbalance.size(); i++)
+        segmentUnbalance[i].add(snapshot.lineUnbalance[i]);
+    
+    for(size_t i=0; i<vehicleSOC.size(); i++) {
+        vehicleEnergy[i] += snapshot.vehicleP[i] * simInterval / 60 / 1000;
+        vehicleSOC[i].add(snapshot.vehicleSOC[i]);
+        vehicleFinalSOC[i] = snapshot.vehicleSOC[i];
+        totalDemand += snapshot.vehicleP[i];
+    }
+    
+    demand.add(totalDemand);
+    networkQuantile[0].add(totalDemand);
+    for(int p=0; p<4; p++) {
+        phaseI[p].add(snapshot.phaseI[3*p]);
+        networkQuantile[p+1].add(snapshot.phaseI[3*p]);
+    }
+    loadFlowIterations.add(snapshot.loadFlowIterations);
+    networkQuantile[5].add(snapshot.loadFlowIterations);
+}
+
+void LogStatistics::write(std::string directory) {
+    std::ofstream outfile;
+    std::string lower = "P" + utility::int2string((int)(quantile*100 + 0.5));
+    std::string upper = "P" + utility::int2string((int)((1-quantile)*100 + 0.5));
+    
+    outfile.open((directory + "summary_households.csv").c_str());
+    outfile << "House, Min V, " << lower << " V, Mean V, Std dev V, Max V, Intervals below min V, Time below min V (h)" << std::endl;
+    for(size_t i=0; i<householdV.size(); i++)
+        outfile << householdNames[i] << ", "
+                << householdV[i].getMin() << ", "
+                << householdVQuantile[i].get() << ", "
+                << householdV[i].getMean() << ", "
+                << householdV[i].getStdDev() << ", "
+                << householdV[i].getMax() << ", "
+                << householdUnderVoltage[i] << ", "
+                << householdUnderVoltage[i] * simInterval / 60.0 << std::endl;
+    outfile.close();
+    
+    outfile.open((directory + "summary_lineSegments.csv").c_str());
+    outfile << "Segment, Mean unbalance, Std dev unbalance, Max unbalance" << std::endl;
+    for(size_t i=0; i<segmentUnbalance.size(); i++)
+        outfile << segmentNames[i] << ", "
+                << segmentUnbalance[i].getMean() << ", "
+                << segmentUnbalance[i].getStdDev() << ", "
+                << segmentUnbalance[i].getMax() << std::endl;
+    outfile.close();
+    
+    outfile.open((directory + "summary_network.csv").c_str());
+    outfile << "Quantity, Min, Mean, Std dev, Max, " << upper << std::endl;
+    std::string names[6] = {"Total demand (W)", "I_PhaseA_RMS", "I_PhaseB_RMS", "I_PhaseC_RMS", "I_Neutral_RMS", "Load flow iterations"};
+    for(int i=0; i<6; i++) {
+        RunningStats &stats = (i == 0) ? demand : (i == 5) ? loadFlowIterations : phaseI[i-1];
+        outfile << names[i] << ", "
+                << stats.getMin() << ", "
+                << stats.getMean() << ", "
+                << stats.getStdDev() << ", "
+                << stats.getMax() << ", "
+                << networkQuantile[i].get() << std::endl;
+    }
+    outfile.close();
+    
+    outfile.open((directory + "summary_vehicles.csv").c_str());
+    outfile << "Vehicle, Energy (kWh), Min SOC, Mean SOC, Max SOC, Final SOC" << std::endl;
+    for(size_t i=0; i<vehicleSOC.size(); i++)
+        outfile << vehicleNames[i] << ", "
+                << vehicleEnergy[i] << ", "
+                << vehicleSOC[i].getMin() << ", "
+                << vehicleSOC[i].getMean() << ", "
+                << vehicleSOC[i].getMax() << ", "
+                << vehicleFinalSOC[i] << std::endl;
+    outfile.close();
+}
+
+void LogStatistics::saveState(std::ostream &out) {
+    for(size_t i=0; i<householdV.size(); i++) {
+        householdV[i].saveState(out);
+        householdVQuantile[i].saveState(out);
+        utility::writeBinary(out, householdUnderVoltage[i]);
+    }
+    for(size_t i=0; i<segmentUnbalance.size(); i++)
+        segmentUnbalance[i].saveState(out);
+    demand.saveState(out);
+    for(int p=0; p<4; p++)
+        phaseI[p].saveState(out);
+    loadFlowIterations.saveState(out);
+    for(size_t i=0; i<networkQuantile.size(); i++)
+        networkQuantile[i].saveState(out);
+    for(size_t i=0; i<vehicleSOC.size(); i++) {
+        utility::writeBinary(out, vehicleEnergy[i]);
+        vehicleSOC[i].saveState(out);
+        utility::writeBinary(out, vehicleFinalSOC[i]);
+    }
+}
+
+void LogStatistics::loadState(std::istream &in) {
+    for(size_t i=0; i<householdV.size(); i++) {
+        householdV[i].loadState(in);
+        householdVQuantile[i].loadState(in);
+        utility::readBinary(in, householdUnderVoltage[i]);
+    }
+    for(size_t i=0; i<segmentUnbalance.size(); i++)
+        segmentUnbalance[i].loadState(in);
+    demand.loadState(in);
+    for(int p=0; p<4; p++)
+        phaseI[p].loadState(in);
+    loadFlowIterations.loadState(in);
+    for(size_t i=0; i<networkQuantile.size(); i++)
+        networkQuantile[i].loadState(in);
+    for(size_t i=0; i<vehicleSOC.size(); i++) {
+        utility::readBinary(in, vehicleEnergy[i]);
+        vehicleSOC[i].loadState(in);
+        utility::readBinary(in, vehicleFinalSOC[i]);
+    }
+}
@@ -0,0 +1,122 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef LOGSTATISTICS_H
+#define	LOGSTATISTICS_H
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Config.h"
+#include "../gridmodel/GridModel.h"
+#include "../utility/Statistics.h"
+#include "../utility/Utility.h"
+
+struct LogSnapshot;
+
+
+/** Summary statistics of a simulation run, accumulated one interval at a time
+  * (used in place of full log files when logmode is "statistics"):  voltage 
+  * of each household, voltage unbalance of each line segment, demand and 
+  * phase currents at the transformer, and energy and SOC of each vehicle.  
+  * Written as a few small summary files at the end of the run. */
+class LogStatistics {
+    
+private:
+    /** Names of households, line segments, vehicles, in logging order. */
+    std::vector<std::string> householdNames;
+    std::vector<std::string> segmentNames;
+    std::vector<std::string> vehicleNames;
+    
+    /** Minimum voltage allowed (local copy of config variable). */
+    int minVoltage;
+    
+    /** Length of sim interval in minutes (local copy of config variable). */
+    int simInterval;
+    
+    /** Quantile of household voltage (lower) and network values (upper) 
+      * to estimate, e.g. 0.05 for 5th and 95th percentile. */
+    double quantile;
+    
+    /** RMS voltage of each household. */
+    std::vector<RunningStats> householdV;
+    std::vector<P2Quantile> householdVQuantile;
+    
+    /** Number of intervals each household was below minimum voltage. */
+    std::vector<long> householdUnderVoltage;
+    
+    /** Voltage unbalance of each line segment. */
+    std::vector<RunningStats> segmentUnbalance;
+    
+    /** Total demand, and RMS current of each phase and neutral at transformer. */
+    RunningStats demand;
+    RunningStats phaseI[4];
+    
+    /** Iterations each load flow took to converge. */
+    RunningStats loadFlowIterations;
+    
+    /** Upper quantile of demand, of phase currents, and of load flow 
+      * iterations. */
+    std::vector<P2Quantile> networkQuantile;
+    
+    /** Energy delivered to each vehicle (kWh), and its SOC. */
+    std::vector<double> vehicleEnergy;
+    std::vector<RunningStats> vehicleSOC;
+    std::vector<double> vehicleFinalSOC;
+    
+public:
+    /** Constructor. */
+    LogStatistics(Config* config, const GridModel &gridModel);
+    
+    /** Destructor. */
+    virtual ~LogStatistics();
+    
+    /** Add output of one sim interval. */
+    void update(LogSnapshot &snapshot);
+    
+    /** Write summary files to given directory. */
+    void write(std::string directory);
+    
+    /** Write all accumulators to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read all accumulators from checkpoint. */
+    void loadState(std::istream &in);
+};
+
+#endif	/* LOGSTATISTICS_H */
@@ -35,163 +35,283 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "Logging.h"
 
 Logging::Logging() {
+    appending = false;
+    format = LogFile::CSV;
+    valueType = LogFile::Float32;
+    chunkSize = 1;
+    compressLogs = false;
+    statistics = NULL;
+    bufferSize = 0;
+    pending = NULL;
+    spare = NULL;
+    flushRequested = false;
+    stopWriter = false;
+    writer = NULL;
 }
 
 Logging::~Logging() {
+    finish();
 }
 
 // Initialise.  Create directory for this simulation run, create all log files.
-void Logging::initialise(Config* config, GridModel gridmodel) {
+void Logging::initialise(Config* config, const GridModel &gridmodel) {
     std::ofstream outfile;
+    std::stringstream header;
     
     std::cout << " - Creating log files ...";
     std::cout.flush();    
     
-    // Create directory
-    createDir();
+    // Snapshots are allocated once, and passed back and forth to writer
+    bufferSize = config->getInt("logbuffersize");
+    if(bufferSize < 1) {
+        std::cout << "Error: log buffer size must be at least 1" << std::endl;
+        exit(1);
+    }
+    pending = new boost::lockfree::spsc_queue<LogSnapshot*>(bufferSize);
+    spare = new boost::lockfree::spsc_queue<LogSnapshot*>(bufferSize);
+    for(int i=0; i<bufferSize; i++)
+        spare->push(new LogSnapshot);
     
-    // Create file with all parameters for this simulation
-    file_parameters = directory + "sim_parameters.txt";
-    outfile.open(file_parameters.c_str());
-    outfile << config->toString() << std::endl;
-    outfile.close();
+    // Format of data log files
+    std::string logFormat = config->getString("logformat");
+    if(logFormat == "csv") 
+        format = LogFile::CSV;
+    else if(logFormat == "binary")
+        format = LogFile::Binary;
+    else {
+        std::cout << "Error: unknown log format " << logFormat << " (use csv or binary)" << std::endl;
+        exit(1);
+    }
+    valueType = (config->getInt("logbinaryprecision") == 64) ? LogFile::Float64 : LogFile::Float32;
+    chunkSize = config->getInt("logchunksize");
+    compressLogs = (config->getString("logcompression") == "gzip");
+    if(!compressLogs && config->getString("logcompression") != "none") {
+        std::cout << "Error: unknown log compression " << config->getString("logcompression") << " (use none or gzip)" << std::endl;
+        exit(1);
+    }
+    if(chunkSize < 1) {
+        std::cout << "Error: log chunk size must be at least 1" << std::endl;
+        exit(1);
+    }
     
-    // Create file with all households and their phases
-    file_house_phases = directory + "house_phases.csv";
-    outfile.open(file_house_phases.c_str());
-    for(std::map<std::string, Household*>::iterator it=gridmodel.households.begin(); it!= gridmodel.households.end(); ++it)
-        outfile << it->second->name << ", " << it->second->phase << std::endl;
-    outfile.close();
+    // Create directory, unless one was given
+    if(directory.empty())
+        createDir();
+    setFileNames();
+    
+    // Unless resuming a simulation (when files exist already and are 
+    // appended to), create file with all parameters for this simulation
+    if(!appending) {
+        outfile.open(file_parameters.c_str());
+        outfile << config->toString() << std::endl;
+        outfile.close();
+
+        // Create file with all households and their phases
+        outfile.open(file_house_phases.c_str());
+        for(std::map<std::string, Household*>::const_iterator it=gridmodel.households.begin(); it!= gridmodel.households.end(); ++it)
+            outfile << it->second->name << ", " << it->second->phase << std::endl;
+        outfile.close();
+    }
+    
+    // In statistics-only mode, no data log files are needed
+    if(config->getString("logmode") == "statistics") {
+        statistics = new LogStatistics(config, gridmodel);
+        std::cout << " OK (statistics only)" << std::endl;
+        return;
+    }
+    else if(config->getString("logmode") != "full") {
+        std::cout << "Error: unknown log mode " << config->getString("logmode") << " (use full or statistics)" << std::endl;
+        exit(1);
+    }
     
     // Create household demand log file
-    file_demandHH = directory + "data_demand_HH.csv";
-    outfile.open(file_demandHH.c_str());
-    outfile << "Time, ";
-    outfile << houseNameList(gridmodel.households);
-    outfile << std::endl;
-    outfile.close();
+    header << "Time, " << houseNameList(gridmodel.households) << std::endl;
+    createFile(file_demandHH, header, valueType, true, gridmodel.households.size());
 
     // Create vehicle demand log file
-    file_demandEV = directory + "data_demand_EV.csv";
-    outfile.open(file_demandEV.c_str());
-    outfile << "Time, ";
-    outfile << vehicleNameList(gridmodel.vehicles);
-    outfile << std::endl;
-    outfile.close();
+    header << "Time, " << vehicleNameList(gridmodel.vehicles) << std::endl;
+    createFile(file_demandEV, header, valueType, true, gridmodel.vehicles.size());
     
     // Create total demand log file
-    file_demandTotal = directory + "data_demand_Total.csv";
-    outfile.open(file_demandTotal.c_str());
-    outfile << "Time, Demand_HH, Demand_EV, Demand_Total" << std::endl;
-    outfile.close();
+    header << "Time, Demand_HH, Demand_EV, Demand_Total" << std::endl;
+    createFile(file_demandTotal, header, valueType, false, 3);
     
     // Create vehicle location log file
-    file_locationEV = directory + "data_vehicleLocations.csv";
-    outfile.open(file_locationEV.c_str());
-    outfile << "Time, ";
-    outfile << vehicleNameList(gridmodel.vehicles);
-    outfile << std::endl;
-    outfile.close();
+    header << "Time, " << vehicleNameList(gridmodel.vehicles) << std::endl;
+    createFile(file_locationEV, header, LogFile::Int32, true, gridmodel.vehicles.size());
     
     // Create spot price log file
-    file_spotPrice = directory + "data_spotPrice.csv";
-    outfile.open(file_spotPrice.c_str());
-    outfile << "Time, Spot Price" << std::endl;
-    outfile.close();
+    header << "Time, Spot Price" << std::endl;
+    createFile(file_spotPrice, header, valueType, false, 1);
     
     // Create phase and neutral voltage log file
-    file_phaseV = directory + "data_phaseV.csv";
-    outfile.open(file_phaseV.c_str());
-    outfile << "Time, "
-            << "V_PhaseA_RMS, V_PhaseA_Mag, V_PhaseA_Pha, "
-            << "V_PhaseB_RMS, V_PhaseB_Mag, V_PhaseB_Pha, "
-            << "V_PhaseC_RMS, V_PhaseC_Mag, V_PhaseC_Pha, "
-            << "V_Neutral_RMS, V_Neutral_Mag, V_Neutral_Pha" 
-            << std::endl;
-    outfile.close();
+    header << "Time, "
+           << "V_PhaseA_RMS, V_PhaseA_Mag, V_PhaseA_Pha, "
+           << "V_PhaseB_RMS, V_PhaseB_Mag, V_PhaseB_Pha, "
+           << "V_PhaseC_RMS, V_PhaseC_Mag, V_PhaseC_Pha, "
+           << "V_Neutral_RMS, V_Neutral_Mag, V_Neutral_Pha" 
+           << std::endl;
+    createFile(file_phaseV, header, valueType, true, 12);
     
     // Create phase and neutral current log file
-    file_phaseI = directory + "data_phaseI.csv";
-    outfile.open(file_phaseI.c_str());
-    outfile << "Time, "
-            << "I_PhaseA_RMS, I_PhaseA_Mag, I_PhaseA_Pha, "
-            << "I_PhaseB_RMS, I_PhaseB_Mag, I_PhaseB_Pha, "
-            << "I_PhaseC_RMS, I_PhaseC_Mag, I_PhaseC_Pha, "
-            << "I_Neutral_RMS, I_Neutral_Mag, I_Neutral_Pha" 
-            << std::endl;
-    outfile.close();
+    header << "Time, "
+           << "I_PhaseA_RMS, I_PhaseA_Mag, I_PhaseA_Pha, "
+           << "I_PhaseB_RMS, I_PhaseB_Mag, I_PhaseB_Pha, "
+           << "I_PhaseC_RMS, I_PhaseC_Mag, I_PhaseC_Pha, "
+           << "I_Neutral_RMS, I_Neutral_Mag, I_Neutral_Pha" 
+           << std::endl;
+    createFile(file_phaseI, header, valueType, true, 12);
     
     // Create end-of-line voltage log file
-    file_eolV = directory + "data_eolV.csv";
-    outfile.open(file_eolV.c_str());
-    outfile << "Time, "
-            << "V_PhaseA_RMS, V_PhaseA_Mag, V_PhaseA_Pha, "
-            << "V_PhaseB_RMS, V_PhaseB_Mag, V_PhaseB_Pha, "
-            << "V_PhaseC_RMS, V_PhaseC_Mag, V_PhaseC_Pha, "
-            << "V_Neutral_RMS, V_Neutral_Mag, V_Neutral_Pha" 
-            << std::endl;
-    outfile.close();
+    header << "Time, "
+           << "V_PhaseA_RMS, V_PhaseA_Mag, V_PhaseA_Pha, "
+           << "V_PhaseB_RMS, V_PhaseB_Mag, V_PhaseB_Pha, "
+           << "V_PhaseC_RMS, V_PhaseC_Mag, V_PhaseC_Pha, "
+           << "V_Neutral_RMS, V_Neutral_Mag, V_Neutral_Pha" 
+           << std::endl;
+    createFile(file_eolV, header, valueType, true, 12);
     
     // Create power factor log file
-    file_powerFactor = directory + "data_powerFactor.csv";
-    outfile.open(file_powerFactor.c_str());
-    outfile << "Time, PhaseA, PhaseB, PhaseC, Neutral" << std::endl;
-    outfile.close();
+    header << "Time, PhaseA, PhaseB, PhaseC, Neutral" << std::endl;
+    createFile(file_powerFactor, header, valueType, false, 4);
 
     // Create household voltage log file
-    file_householdV = directory + "data_householdV_RMS.csv";
-    outfile.open(file_householdV.c_str());
-    outfile << "Time, ";
-    for(std::map<std::string,Household*>::iterator it = gridmodel.households.begin(); it != gridmodel.households.end(); ++it)
-        outfile << it->second->name << " (House " << it->second->NMI << "), "
-                << "House " << it->second->NMI << " Magnitude, "
-                << "House " << it->second->NMI << " Phase, ";
-    outfile << std::endl;
-    outfile.close();
+    header << "Time, ";
+    for(std::map<std::string,Household*>::const_iterator it = gridmodel.households.begin(); it != gridmodel.households.end(); ++it)
+        header << it->second->name << " (House " << it->second->NMI << "), "
+               << "House " << it->second->NMI << " Magnitude, "
+               << "House " << it->second->NMI << " Phase, ";
+    header << std::endl;
+    createFile(file_householdV, header, valueType, true, 3*gridmodel.households.size());
     
     // Create battery SOC file
-    file_batterySOC = directory + "data_batterySOC.csv";
-    outfile.open(file_batterySOC.c_str());
-    outfile << "Time, ";
-    outfile << vehicleNameList(gridmodel.vehicles);
-    outfile << std::endl;
-    outfile.close();
+    header << "Time, " << vehicleNameList(gridmodel.vehicles) << std::endl;
+    createFile(file_batterySOC, header, valueType, true, gridmodel.vehicles.size());
     
     // Create charging probabilities file
-    file_probchargeEV = directory + "data_probChargeEV.csv";
-    outfile.open(file_probchargeEV.c_str());
-    outfile << "Time, ";
-    for(std::map<std::string,Vehicle*>::iterator it = gridmodel.vehicles.begin(); it != gridmodel.vehicles.end(); ++it)
-        outfile << gridmodel.findHousehold(it->second->getNMI())->name << " (" << it->second->getNMI() << "), , , , , , , ";
-    outfile << std::endl;
-    outfile << "Time, ";
-    for(std::map<std::string,Vehicle*>::iterator it = gridmodel.vehicles.begin(); it != gridmodel.vehicles.end(); ++it)
-        outfile << "V_RMS, V_Valley, L, SOC, N, P, SwitchedOn, ";
-    outfile << std::endl;
-    outfile.close();
+    header << "Time, ";
+    for(std::map<std::string,Vehicle*>::const_iterator it = gridmodel.vehicles.begin(); it != gridmodel.vehicles.end(); ++it)
+        header << gridmodel.findHousehold(it->second->getNMI())->name << " (" << it->second->getNMI() << "), , , , , , , ";
+    header << std::endl;
+    header << "Time, ";
+    for(std::map<std::string,Vehicle*>::const_iterator it = gridmodel.vehicles.begin(); it != gridmodel.vehicles.end(); ++it)
+        header << "V_RMS, V_Valley, L, SOC, N, P, SwitchedOn, ";
+    header << std::endl;
+    createFile(file_probchargeEV, header, valueType, true, 7*gridmodel.vehicles.size());
     
     // Create true phase unbalance measurements file
-    file_phaseUnbalance_true = directory + "data_phaseUnbalanceTrue.csv";
-    outfile.open(file_phaseUnbalance_true.c_str());
-    outfile << "Time, ";
-    for(std::map<std::string,FeederLineSegment*>::iterator it = gridmodel.lineSegments.begin(); it != gridmodel.lineSegments.end(); ++it)
-        outfile << it->second->name << ", ";
-    outfile << std::endl;
-    outfile.close();
+    header << "Time, ";
+    for(std::map<std::string,FeederLineSegment*>::const_iterator it = gridmodel.lineSegments.begin(); it != gridmodel.lineSegments.end(); ++it)
+        header << it->second->name << ", ";
+    header << std::endl;
+    createFile(file_phaseUnbalance_true, header, valueType, true, gridmodel.lineSegments.size());
 
     // Create "deviation from average" phase unbalance measurements file
-    file_phaseUnbalance_deviation = directory + "data_phaseUnbalanceDeviation.csv";
-    outfile.open(file_phaseUnbalance_deviation.c_str());
-    outfile << "Time, Deviation" << std::endl;
-    outfile.close();
+    header << "Time, Deviation" << std::endl;
+    createFile(file_phaseUnbalance_deviation, header, valueType, false, 1);
+    
+    // Create load flow iterations file
+    header << "Time, Iterations" << std::endl;
+    createFile(file_loadFlowIterations, header, LogFile::Int32, false, 1);
+    
+    // Create load flow cache statistics file, if cache is used
+    if(gridmodel.loadFlowCache != NULL) {
+        header << "Time, Hits, Misses, Entries, Memory (kB)" << std::endl;
+        createFile(file_loadFlowCache, header, LogFile::Int32, false, 4);
+    }
 
-    std::cout << " OK" << std::endl;
+    if(appending)
+        std::cout << " OK (appending to existing files)" << std::endl;
+    else
+        std::cout << " OK" << std::endl;
+}
+
+void Logging::createFile(std::string file, std::stringstream &header, LogFile::ColumnType type, bool trailingSeparator, int numColumns) {
+    files[file] = new LogFile(file, format, type, compressLogs, trailingSeparator, numColumns, chunkSize);
+    if(!appending)
+        files[file]->create(header.str());
+    header.str("");
 }
 
 std::string Logging::getDir() {
     return directory;
 }
 
+void Logging::setFileNames() {
+    std::string extension = (format == LogFile::Binary) ? ".bin" : ".csv";
+    if(compressLogs)
+        extension += ".gz";
+    
+    file_parameters = directory + "sim_parameters.txt";
+    file_house_phases = directory + "house_phases.csv";
+    file_demandHH = directory + "data_demand_HH" + extension;
+    file_demandEV = directory + "data_demand_EV" + extension;
+    file_demandTotal = directory + "data_demand_Total" + extension;
+    file_locationEV = directory + "data_vehicleLocations" + extension;
+    file_spotPrice = directory + "data_spotPrice" + extension;
+    file_phaseV = directory + "data_phaseV" + extension;
+    file_phaseI = directory + "data_phaseI" + extension;
+    file_eolV = directory + "data_eolV" + extension;
+    file_powerFactor = directory + "data_powerFactor" + extension;
+    file_householdV = directory + "data_householdV_RMS" + extension;
+    file_batterySOC = directory + "data_batterySOC" + extension;
+    file_probchargeEV = directory + "data_probChargeEV" + extension;
+    file_phaseUnbalance_true = directory + "data_phaseUnbalanceTrue" + extension;
+    file_phaseUnbalance_deviation = directory + "data_phaseUnbalanceDeviation" + extension;
+    file_loadFlowCache = directory + "data_loadFlowCache" + extension;
+    file_loadFlowIterations = directory + "data_loadFlowIterations" + extension;
+}
+
+void Logging::resume(std::string dir) {
+    directory = dir;
+    if(directory[directory.length()-1] != '/')
+        directory += "/";
+    appending = true;
+}
+
+void Logging::saveState(std::ostream &out) {
+    flush();
+    
+    // Only data log files are rolled back on resume; other files in the log
+    // directory (parameters, house phases, the checkpoint itself) are not
+    utility::writeBinary(out, (int)files.size());
+    for(std::map<std::string, LogFile*>::iterator it = files.begin(); it != files.end(); ++it) {
+        boost::filesystem::path file(it->first);
+        long size = boost::filesystem::exists(file) ? (long)boost::filesystem::file_size(file) : 0;
+        utility::writeBinary(out, file.filename().string());
+        utility::writeBinary(out, size);
+    }
+    
+    if(statistics != NULL)
+        statistics->saveState(out);
+}
+
+void Logging::loadState(std::istream &in) {
+    int numFiles;
+    std::string fileName;
+    long size;
+    
+    utility::readBinary(in, numFiles);
+    for(int i=0; i<numFiles; i++) {
+        utility::readBinary(in, fileName);
+        utility::readBinary(in, size);
+        if(files.find(directory + fileName) == files.end())
+            continue;
+        boost::filesystem::path file(directory + fileName);
+        if(boost::filesystem::exists(file) && (long)boost::filesystem::file_size(file) > size)
+            boost::filesystem::resize_file(file, size);
+    }
+    
+    if(statistics != NULL)
+        statistics->loadState(in);
+}
+
+void Logging::setDir(std::string dir) {
+    boost::filesystem::path logDir(dir);
+    boost::filesystem::create_directories(logDir);
+    directory = dir;
+}
+
 // Create a directory for all logging output of this simulation
 // Format:  /POSSIM_home/yyyy_mm_dd/hh_mm_ss
 void Logging::createDir() {
@@ -246,136 +366,235 @@ void Logging::createDir() {
     }
 }
 
-std::string Logging::houseNameList(std::map<std::string,Household*> households) {
+std::string Logging::houseNameList(const std::map<std::string,Household*> &households) {
     std::stringstream ss;
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it)
+    for(std::map<std::string,Household*>::const_iterator it = households.begin(); it != households.end(); ++it)
         ss << it->first << ", ";
     return ss.str();
 }
 
-std::string Logging::vehicleNameList(std::map<std::string,Vehicle*> vehicles) {
+std::string Logging::vehicleNameList(const std::map<std::string,Vehicle*> &vehicles) {
     std::stringstream ss;
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
+    for(std::map<std::string,Vehicle*>::const_iterator it = vehicles.begin(); it != vehicles.end(); ++it)
         ss << it->first << ", ";
     return ss.str();
 }
 
-// Update log files with output of current sim interval
-void Logging::update(DateTime currtime, GridModel gridModel, ChargingBaseClass *charger, SpotPrice spotPrice) {
+// Copy output of current sim interval, and pass it on to writer thread
+void Logging::update(DateTime currtime, const GridModel &gridModel, const SpotPrice &spotPrice) {
     std::cout << "Updating logs ...";
     
-    std::map<std::string,Household*> households = gridModel.households;
-    std::map<std::string,Vehicle*> vehicles = gridModel.vehicles;
-    std::ofstream outfile;
-    double powerEV=0, powerHH=0;
+    if(writer == NULL)
+        writer = new boost::thread(boost::bind(&Logging::runWriter, this));
+    
+    // If writer has fallen behind by a full buffer, wait for it
+    LogSnapshot* snapshot;
+    if(!spare->pop(snapshot)) {
+        boost::mutex::scoped_lock lock(writerMutex);
+        while(!spare->pop(snapshot))
+            writerDone.wait(lock);
+    }
+    
+    const std::map<std::string,Household*> &households = gridModel.households;
+    const std::map<std::string,Vehicle*> &vehicles = gridModel.vehicles;
+    
+    snapshot->time = currtime;
+    const double* householdP = gridModel.getHouseholdActive();
+    if(householdP != NULL)
+        snapshot->householdP.assign(householdP, householdP + households.size());
+    else
+        snapshot->householdP.assign(households.size(), 0);
+    snapshot->householdV.clear();
+    for(std::map<std::string,Household*>::const_iterator it = households.begin(); it != households.end(); ++it) {
+        snapshot->householdV.push_back(it->second->V_RMS);
+        snapshot->householdV.push_back(it->second->V_Mag);
+        snapshot->householdV.push_back(it->second->V_Pha);
+    }
+    
+    snapshot->vehicleP.clear();
+    snapshot->vehicleLocation.clear();
+    snapshot->vehicleSOC.clear();
+    snapshot->vehicleCharging.clear();
+    for(std::map<std::string,Vehicle*>::const_iterator it = vehicles.begin(); it != vehicles.end(); ++it) {
+        Household* household = gridModel.findHousehold(it->second->getNMI());
+        snapshot->vehicleP.push_back(it->second->activePower);
+        if(it->second->location == 1)
+            snapshot->vehicleLocation.push_back(it->second->isConnected ? 1.0 : 2.0);
+        else
+            snapshot->vehicleLocation.push_back(0);
+        snapshot->vehicleSOC.push_back(it->second->getSOC());
+        snapshot->vehicleCharging.push_back(household->V_RMS);
+        snapshot->vehicleCharging.push_back(household->V_valley);
+        snapshot->vehicleCharging.push_back(it->second->L);
+        snapshot->vehicleCharging.push_back(it->second->getSOC());
+        snapshot->vehicleCharging.push_back(it->second->N);
+        snapshot->vehicleCharging.push_back(it->second->P);
+        snapshot->vehicleCharging.push_back(it->second->switchon);
+    }
+    
+    snapshot->lineUnbalance.clear();
+    for(std::map<std::string,FeederLineSegment*>::const_iterator it = gridModel.lineSegments.begin(); it != gridModel.lineSegments.end(); ++it) 
+        snapshot->lineUnbalance.push_back(it->second->voltageUnbalance);
+    
+    for(int i=0; i<12; i++) {
+        snapshot->phaseV[i] = gridModel.networkData.phaseV[i];
+        snapshot->phaseI[i] = gridModel.networkData.phaseI[i];
+        snapshot->eolV[i] = gridModel.networkData.eolV[i];
+    }
+    snapshot->spotPrice = spotPrice.price;
+    snapshot->deviation = gridModel.getDeviation(currtime);
+    snapshot->loadFlowIterations = gridModel.networkData.iterations;
+    
+    snapshot->hasCache = (gridModel.loadFlowCache != NULL);
+    if(snapshot->hasCache) {
+        snapshot->cacheHits = gridModel.loadFlowCache->hits;
+        snapshot->cacheMisses = gridModel.loadFlowCache->misses;
+        snapshot->cacheEntries = gridModel.loadFlowCache->size();
+        snapshot->cacheMemory = gridModel.loadFlowCache->getMemoryUsed();
+    }
+    
+    pending->push(snapshot);
+    {
+        boost::mutex::scoped_lock lock(writerMutex);
+        writerWake.notify_one();
+    }
+    
+    std::cout << " OK" << std::endl;
+}
+
+void Logging::flush() {
+    if(writer == NULL)
+        return;
+    
+    boost::mutex::scoped_lock lock(writerMutex);
+    flushRequested = true;
+    writerWake.notify_one();
+    while(flushRequested)
+        writerDone.wait(lock);
+}
 
-    outfile.open(file_demandHH.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) {
-        outfile << it->second->activePower << ", ";
-        powerHH += it->second->activePower;
+void Logging::finish() {
+    if(writer != NULL) {
+        {
+            boost::mutex::scoped_lock lock(writerMutex);
+            stopWriter = true;
+            writerWake.notify_one();
+        }
+        writer->join();
+        delete writer;
+        writer = NULL;
+        stopWriter = false;
+        
+        if(statistics != NULL)
+            statistics->write(directory);
+    }
+    
+    for(std::map<std::string, LogFile*>::iterator it = files.begin(); it != files.end(); ++it)
+        delete it->second;
+    files.clear();
+    
+    // With the writer stopped, all snapshots are back in one of the queues
+    LogSnapshot* snapshot;
+    if(pending != NULL) {
+        while(pending->pop(snapshot))
+            delete snapshot;
+        delete pending;
+        pending = NULL;
     }
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_demandEV.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it) {
-        outfile << it->second->activePower << ", ";
-        powerEV += it->second->activePower;
+    if(spare != NULL) {
+        while(spare->pop(snapshot))
+            delete snapshot;
+        delete spare;
+        spare = NULL;
     }
-    outfile << std::endl;
-    outfile.close();
     
-    outfile.open(file_demandTotal.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", " << powerHH << ", " << powerEV << ", " << (powerHH+powerEV) << std::endl;
-    outfile.close();
+    delete statistics;
+    statistics = NULL;
+}
+
+void Logging::runWriter() {
+    LogSnapshot* snapshot;
+    bool flushing, stopping;
     
-    outfile.open(file_locationEV.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it)
-        if(it->second->location == 1)
-            if(it->second->isConnected)
-                outfile << "1, ";  // home, connected
-            else
-                outfile << "2, ";  // home, not connected
-        else                       
-            outfile << "0, ";      // not home
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_spotPrice.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", " << spotPrice.price << std::endl;
-    outfile.close();
-
-    outfile.open(file_phaseV.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(int i=0; i<12; i++)
-        outfile << gridModel.networkData.phaseV[i] << ", ";
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_phaseI.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(int i=0; i<12; i++)
-        outfile << gridModel.networkData.phaseI[i] << ", ";
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_eolV.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(int i=0; i<12; i++)
-        outfile << gridModel.networkData.eolV[i] << ", ";
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_powerFactor.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", "
-            << utility::calcPowerFactor(gridModel.networkData.phaseV[2], gridModel.networkData.phaseI[2]) << ", "
-            << utility::calcPowerFactor(gridModel.networkData.phaseV[5], gridModel.networkData.phaseI[5]) << ", "
-            << utility::calcPowerFactor(gridModel.networkData.phaseV[8], gridModel.networkData.phaseI[8]) << ", "
-            << utility::calcPowerFactor(gridModel.networkData.phaseV[11], gridModel.networkData.phaseI[11])
-            << std::endl;
-    outfile.close();
-
-    outfile.open(file_householdV.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(std::map<std::string,Household*>::iterator it = households.begin(); it != households.end(); ++it) 
-        outfile << it->second->V_RMS << ", " << it->second->V_Mag << ", " << it->second->V_Pha << ", ";
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_batterySOC.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it) 
-        outfile << it->second->getSOC()  << ", ";
-    outfile << std::endl;
-    outfile.close();
+    // Only once all snapshots are written, act on requests to flush or stop
+    while(true) {
+        if(pending->pop(snapshot)) {
+            writeSnapshot(*snapshot);
+            spare->push(snapshot);
+            boost::mutex::scoped_lock lock(writerMutex);
+            writerDone.notify_one();
+            continue;
+        }
+        
+        {
+            boost::mutex::scoped_lock lock(writerMutex);
+            while(pending->read_available() == 0 && !flushRequested && !stopWriter)
+                writerWake.wait(lock);
+            flushing = flushRequested;
+            stopping = stopWriter;
+        }
+        if(pending->read_available() > 0)
+            continue;
         
-    outfile.open(file_probchargeEV.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it) 
-        outfile << gridModel.findHousehold(it->second->getNMI())->V_RMS << ", "
-                << gridModel.findHousehold(it->second->getNMI())->V_valley << ", "
-                << it->second->L << ", " 
-                << it->second->getSOC() << ", "
-                << it->second->N << ", "
-                << it->second->P << ", "
-                << it->second->switchon << ", ";
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_phaseUnbalance_true.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    for(std::map<std::string,FeederLineSegment*>::iterator it = gridModel.lineSegments.begin(); it != gridModel.lineSegments.end(); ++it) 
-        outfile << it->second->voltageUnbalance << ", ";
-    outfile << std::endl;
-    outfile.close();
-    
-    outfile.open(file_phaseUnbalance_deviation.c_str(), std::ofstream::app);
-    outfile << currtime.toString() << ", ";
-    outfile << gridModel.getDeviation(currtime) << std::endl;
-    outfile.close();
+        if(flushing || stopping) {
+            for(std::map<std::string, LogFile*>::iterator it = files.begin(); it != files.end(); ++it)
+                it->second->flush();
+            if(stopping)
+                return;
+            boost::mutex::scoped_lock lock(writerMutex);
+            flushRequested = false;
+            writerDone.notify_one();
+        }
+    }
+}
+
+// Write output of one sim interval to log files
+void Logging::writeSnapshot(LogSnapshot &snapshot) {
+    ProfileZone zone("write log");
+    DateTime &time = snapshot.time;
+    double values[4];
+    double powerEV=0, powerHH=0;
     
-    std::cout << " OK" << std::endl;
+    if(statistics != NULL) {
+        statistics->update(snapshot);
+        return;
+    }
+
+    for(int i=0; i<snapshot.householdP.size(); i++)
+        powerHH += snapshot.householdP[i];
+    for(int i=0; i<snapshot.vehicleP.size(); i++)
+        powerEV += snapshot.vehicleP[i];
+    
+    files[file_demandHH]->append(time, snapshot.householdP);
+    files[file_demandEV]->append(time, snapshot.vehicleP);
+    
+    values[0] = powerHH;
+    values[1] = powerEV;
+    values[2] = powerHH+powerEV;
+    files[file_demandTotal]->append(time, values);
+    
+    files[file_locationEV]->append(time, snapshot.vehicleLocation);
+    files[file_spotPrice]->append(time, &snapshot.spotPrice);
+    files[file_phaseV]->append(time, snapshot.phaseV);
+    files[file_phaseI]->append(time, snapshot.phaseI);
+    files[file_eolV]->append(time, snapshot.eolV);
+    
+    for(int i=0; i<4; i++)
+        values[i] = utility::calcPowerFactor(snapshot.phaseV[3*i+2], snapshot.phaseI[3*i+2]);
+    files[file_powerFactor]->append(time, values);
+    
+    files[file_householdV]->append(time, snapshot.householdV);
+    files[file_batterySOC]->append(time, snapshot.vehicleSOC);
+    files[file_probchargeEV]->append(time, snapshot.vehicleCharging);
+    files[file_phaseUnbalance_true]->append(time, snapshot.lineUnbalance);
+    files[file_phaseUnbalance_deviation]->append(time, &snapshot.deviation);
+    files[file_loadFlowIterations]->append(time, &snapshot.loadFlowIterations);
+    
+    if(snapshot.hasCache) {
+        values[0] = snapshot.cacheHits;
+        values[1] = snapshot.cacheMisses;
+        values[2] = snapshot.cacheEntries;
+        values[3] = snapshot.cacheMemory/1024;
+        files[file_loadFlowCache]->append(time, values);
+    }
 }
@@ -42,6 +42,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <fstream>
 #include <sstream>
 #include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
 
 #include "Config.h"
 #include "../utility/Utility.h"
@@ -49,12 +52,64 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "../household/Household.h"
 #include "../vehicle/Vehicle.h"
 #include "../utility/DateTime.h"
-#include "../charging/ChargingBaseClass.h"
+#include "../utility/Profiler.h"
 #include "../spotprice/SpotPrice.h"
+#include "LogFile.h"
+#include "LogStatistics.h"
+
+/** All output of one sim interval, as copied from the simulation for the log
+  * writer thread.  Snapshots are reused, so their vectors keep their size. */
+struct LogSnapshot {
+    DateTime time;
+    
+    /** Active power of each household, in order of their names. */
+    std::vector<double> householdP;
+    
+    /** Voltage RMS, magnitude, phase of each household. */
+    std::vector<double> householdV;
+    
+    /** Active power of each vehicle, in order of their names. */
+    std::vector<double> vehicleP;
+    
+    /** Location of each vehicle: 0 not home, 1 home and connected, 2 home 
+      * and not connected. */
+    std::vector<double> vehicleLocation;
+    
+    /** State of charge of each vehicle. */
+    std::vector<double> vehicleSOC;
+    
+    /** Household voltage, valley voltage, L, SOC, N, P, switchon of each
+      * vehicle (distributed charging algorithm). */
+    std::vector<double> vehicleCharging;
+    
+    /** Voltage unbalance of each line segment, in order of their names. */
+    std::vector<double> lineUnbalance;
+    
+    double phaseV[12];
+    double phaseI[12];
+    double eolV[12];
+    double spotPrice;
+    double deviation;
+    
+    /** Iterations the load flow took to converge (0 if not reported, e.g.
+      * when taken from the load flow cache). */
+    double loadFlowIterations;
+    
+    /** Load flow cache statistics (if a cache is used). */
+    bool hasCache;
+    long cacheHits;
+    long cacheMisses;
+    int cacheEntries;
+    size_t cacheMemory;
+};
 
 /** Takes care of all logging.
  * This class ensures that all relevant system parameters and simulation outputs
- * are logged.
+ * are logged.  Output of each interval is copied into a snapshot and passed 
+ * through a lock-free ring buffer to a writer thread, which formats it and 
+ * writes it to file while the simulation continues.  In statistics-only mode,
+ * the writer thread instead accumulates summary statistics, written once at
+ * the end of the run.
  */
 class Logging {
     
@@ -62,6 +117,10 @@ private:
     /** Directory containing all log output for this simulation run */
     std::string directory;
     
+    /** True if continuing a previous (checkpointed) run, i.e. log files
+      * exist already and are appended to */
+    bool appending;
+    
     /* Individual log file names below */
     std::string file_parameters;
     std::string file_house_phases;
@@ -79,32 +138,119 @@ private:
     std::string file_probchargeEV;
     std::string file_phaseUnbalance_true;
     std::string file_phaseUnbalance_deviation;
+    std::string file_loadFlowCache;
+    std::string file_loadFlowIterations;
+    
+    /** Data log files, mapped to their names. */
+    std::map<std::string, LogFile*> files;
+    
+    /** Format of data log files (config variable logformat). */
+    LogFile::Format format;
+    
+    /** Type of values in binary log files (config variable logbinaryprecision). */
+    LogFile::ColumnType valueType;
+    
+    /** Rows per chunk in binary log files (local copy of config variable). */
+    int chunkSize;
+    
+    /** True if data log files are gzip compressed (config variable logcompression). */
+    bool compressLogs;
+    
+    /** Summary statistics, if only these are logged (logmode "statistics"),
+      * otherwise NULL. */
+    LogStatistics* statistics;
+    
+    /** Number of snapshots in ring buffer (local copy of config variable). */
+    int bufferSize;
+    
+    /** Snapshots filled by simulation, waiting to be written. */
+    boost::lockfree::spsc_queue<LogSnapshot*>* pending;
+    
+    /** Snapshots already written, free to be filled again. */
+    boost::lockfree::spsc_queue<LogSnapshot*>* spare;
+    
+    /** Set to make writer thread flush all log files once all snapshots
+      * are written;  cleared by writer once done.  Guarded by writerMutex. */
+    bool flushRequested;
+    
+    /** Set to make writer thread exit once all snapshots are written. 
+      * Guarded by writerMutex. */
+    bool stopWriter;
+    
+    /** Guards flushRequested and stopWriter, and waiting on the condition
+      * variables below (the queues themselves are lock-free). */
+    boost::mutex writerMutex;
+    
+    /** Wakes writer thread when a snapshot is pending, or on a request to
+      * flush or stop. */
+    boost::condition_variable writerWake;
+    
+    /** Wakes simulation when a snapshot is spare again, or a flush is done. */
+    boost::condition_variable writerDone;
+    
+    /** Writer thread, NULL until the first update. */
+    boost::thread* writer;
 
 public:
     /** Constructor */
     Logging();
     
     /** Initialise.  Create all logging output files. */
-    void initialise(Config* config, GridModel gridmodel);
+    void initialise(Config* config, const GridModel &gridmodel);
     
     /** Destructor */
     virtual ~Logging();
     
     /** Retrieve name of directory containing log files for this run. */
     std::string getDir();
+    
+    /** Use the given directory (created if needed) for log files, rather 
+      * than creating a new one on initialisation. */
+    void setDir(std::string dir);
+    
+    /** Create a directory for current simulation run. */
+    void createDir();
+    
+    /** Continue logging into the existing files in given directory (e.g. 
+      * when resuming from a checkpoint) rather than creating new ones. */
+    void resume(std::string dir);
+    
+    /** Write size of each data log file (and any statistics) to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read sizes of data log files from checkpoint, and cut files back to them
+      * (dropping any output written after the checkpoint). */
+    void loadState(std::istream &in);
 
     /** Update all log files with current sim interval's output. */
-    void update(DateTime currtime, GridModel gridmodel, ChargingBaseClass *charger, SpotPrice spotPrice);
+    void update(DateTime currtime, const GridModel &gridmodel, const SpotPrice &spotPrice);
+    
+    /** Wait until all updates so far have been written to file. */
+    void flush();
+    
+    /** Write all remaining updates, stop writer thread, and free all log
+      * files and snapshots (no further updates are possible). */
+    void finish();
 
 private:
-    /** Create a directory for current simulation run. */
-    void createDir();
+    /** Set names of all log files within log directory. */
+    void setFileNames();
+    
+    /** Writer thread:  write snapshots to file as they become available. */
+    void runWriter();
+    
+    /** Format and write one interval's output to log files. */
+    void writeSnapshot(LogSnapshot &snapshot);
+    
+    /** Create data log file with given header (unless appending), and 
+      * clear header. */
+    void createFile(std::string file, std::stringstream &header, LogFile::ColumnType type, bool trailingSeparator, int numColumns);
     
     /** Create comma separated list of house names. */
-    std::string houseNameList(std::map<std::string,Household*> households);
+    std::string houseNameList(const std::map<std::string,Household*> &households);
     
     /** Create comma separated list of vehicle names. */
-    std::string vehicleNameList(std::map<std::string,Vehicle*> vehicles);
+    std::string vehicleNameList(const std::map<std::string,Vehicle*> &vehicles);
     
 };
 
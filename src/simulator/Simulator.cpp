@@ -34,6 +34,10 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "Simulator.h"
 
+// Identifies checkpoint files, and version of their format
+static const char CHECKPOINT_ID[8] = {'P','O','S','S','I','M','C','P'};
+static const int CHECKPOINT_VERSION = 2;
+
 Simulator::Simulator(Config* configIn):
         householdDemandModel(configIn),
         trafficModel(configIn),
@@ -43,12 +47,32 @@ Simulator::Simulator(Config* configIn):
     
     // Store local pointer to config object
     config = configIn;
-
-    // Set some global parameters locally for convenience
-    startTime.set(config->getConfigVar("starttime"));
-    currTime = startTime;
-    finishTime.set(config->getConfigVar("finishtime"));
-    showDebug = config->getBool("showdebug");
+    
+    // When resuming, seed is taken from checkpoint so that loading (e.g. 
+    // placement of vehicles) gives the same result as in the original run
+    std::string resumeDir = config->getString("resume");
+    std::ifstream checkpoint;
+    if(resumeDir != "no") {
+        std::string file = (boost::filesystem::path(resumeDir) / "checkpoint.bin").string();
+        checkpoint.open(file.c_str(), std::ios::binary);
+        if(!checkpoint) {
+            std::cout << "Error: cannot open checkpoint file " << file << std::endl;
+            exit(1);
+        }
+        readCheckpointHeader(checkpoint);
+        config->setConfigVar("randomseed", utility::int2string(seed));
+        log.resume(resumeDir);
+    }
+    
+    // Without a given seed, pick one (and record it, so run can be repeated)
+    else {
+        seed = config->getInt("randomseed");
+        if(seed == 0) {
+            seed = (unsigned int)time(NULL);
+            config->setConfigVar("randomseed", utility::int2string(seed));
+        }
+    }
+    std::cout << " - Using random seed " << seed << std::endl;
 
     // Create interface to load flow simulator
     switch(config->getLoadFlowSim()) {
@@ -56,15 +80,61 @@ Simulator::Simulator(Config* configIn):
                         break;
         case 1:         loadflow = new MatlabInterface(config);
                         break;
+        case 3:         loadflow = new NativeInterface(config);
+                        break;
         default:        loadflow = new MatlabInterface(config);
                         break;
     }
     
+    load(householdDemandModel, "");
+    
+    if(checkpoint.is_open())
+        loadCheckpoint(checkpoint);
+}
+
+Simulator::Simulator(Config* configIn, 
+                     HouseholdDemandModel &demandModel, 
+                     TrafficModel &sharedTrafficModel, 
+                     ModelFileParser* parser,
+                     std::string logDir,
+                     unsigned int seedIn):
+        householdDemandModel(configIn),
+        trafficModel(sharedTrafficModel),
+        spotPrice(configIn)
+{
+    std::cout << "Loading Simulator ..." << std::endl;
+    
+    // Store local pointer to config object
+    config = configIn;
+    seed = seedIn;
+    
+    // Only the native solver can run side by side with others
+    loadflow = new NativeInterface(config, parser);
+    
+    load(demandModel, logDir);
+}
+
+void Simulator::load(HouseholdDemandModel &demandModel, std::string logDir) {
+    // Set some global parameters locally for convenience
+    startTime.set(config->getConfigVar("starttime"));
+    currTime = startTime;
+    finishTime.set(config->getConfigVar("finishtime"));
+    showDebug = config->getBool("showdebug");
+    checkpointInterval = config->getInt("checkpointinterval");
+    random = RandomStream(seed, "simulator", 0);
+    
+    summary.minHouseholdV = 1e9;
+    summary.maxHouseholdV = 0;
+    summary.numUnderVoltage = 0;
+    summary.peakDemand = 0;
+    summary.vehicleEnergy = 0;
+    summary.maxVoltageUnbalance = 0;
+    
     // Load model, set initial values
-    gridModel.initialise(config, loadflow);
+    gridModel.initialise(config, loadflow, seed);
     
     // Assign demand profiles to houses
-    householdDemandModel.assignProfiles(gridModel.households);
+    demandModel.assignProfiles(gridModel.households);
     
     // Add vehicles to gridmodel
     gridModel.addVehicles(config);
@@ -95,6 +165,8 @@ Simulator::Simulator(Config* configIn):
         vehicleIDs.push_back(it->second->NMI);
     
     // Initialise log
+    if(!logDir.empty())
+        log.setDir(logDir);
     log.initialise(config, gridModel);
     gridModel.setLogDir(log.getDir());
 
@@ -133,6 +205,8 @@ Simulator::Simulator(Config* configIn):
 }
 
 Simulator::~Simulator() {
+    delete charger;
+    delete loadflow;
 }
 
 // Provide an update on how long the simulation is expected to take to the user
@@ -151,11 +225,12 @@ void Simulator::timingUpdate(boost::posix_time::time_duration lastCycleLength) {
 
 // Run simulation
 void Simulator::run() {
-    // Several variables to keep track of how long cycle / full simulation took
-    boost::posix_time::ptime timerRun, timerCycle;
+    ProfileZone runZone("simulation");
+    
+    // Length of last cycle, to estimate the time remaining
+    boost::posix_time::ptime cycleStart = boost::posix_time::microsec_clock::local_time();
     boost::posix_time::time_duration lastCycleLength;
-    utility::startTimer(timerRun);
-    utility::startTimer(timerCycle);
+    int cyclesSinceCheckpoint = 0;
         
     std::cout << "Starting Simulation ... " << std::endl;
     
@@ -164,48 +239,70 @@ void Simulator::run() {
         std::cout << "-------------------------------------------" << std::endl;        
         currTime.display();
         std::cout << std::endl;
+        ProfileZone intervalZone("interval");
 
         // Update electricity spot price
         spotPrice.update(currTime);
         
         // Update traffic model
-        trafficModel.update(currTime, gridModel.vehicles);
+        {
+            ProfileZone zone("traffic update");
+            trafficModel.update(currTime, gridModel.vehicles);
+        }
         
         // Update vehicles' battery SOC based on distance driven / charging
-        gridModel.updateVehicleBatteries();
+        {
+            ProfileZone zone("battery update");
+            gridModel.updateVehicleBatteries();
+        }
 
         // Update grid model - generate household loads & reset vehicle loads
-        gridModel.generateAllHouseholdLoads(currTime);
-        gridModel.resetVehicleLoads();
+        {
+            ProfileZone zone("household loads");
+            gridModel.generateAllHouseholdLoads(currTime);
+            gridModel.resetVehicleLoads();
+        }
 
         // Depending on charge update model, apply charge rate updates and run load flow
         if(chargeRateOrder == "random")
-            std::random_shuffle(vehicleIDs.begin(), vehicleIDs.end());
+            std::random_shuffle(vehicleIDs.begin(), vehicleIDs.end(), random);
         
         // Determine EV charging rates
         if(chargeRateUpdate == "batch") {
-            charger->setAllChargeRates(currTime, gridModel);
-            gridModel.generateAllVehicleLoads();
+            {
+                ProfileZone zone("charge rates");
+                charger->setAllChargeRates(currTime, gridModel);
+                gridModel.generateAllVehicleLoads();
+            }
             gridModel.runLoadFlow();
         }
         
         else if(chargeRateUpdate == "individual") {
             gridModel.runLoadFlow();
             for(int i=0; i<vehicleIDs.size(); i++) {
-                charger->setOneChargeRate(currTime, gridModel, vehicleIDs.at(i));
-                gridModel.generateOneVehicleLoad(vehicleIDs.at(i));
-                gridModel.runLoadFlow();
+                {
+                    ProfileZone zone("charge rates");
+                    charger->setOneChargeRate(currTime, gridModel, vehicleIDs.at(i));
+                    gridModel.generateOneVehicleLoad(vehicleIDs.at(i));
+                }
+                gridModel.runIncrementalLoadFlow(std::vector<int>(1, vehicleIDs.at(i)));
             }
         }
         
         else {  // "grouped"
             gridModel.runLoadFlow();
+            std::vector<int> group;
             for(int i=0; i<vehicleIDs.size(); i+=chargeRateGroupSize) {
-                for(int j=i; j<std::min((int)gridModel.vehicles.size(), (int)(i+chargeRateGroupSize)); j++) {
-                    charger->setOneChargeRate(currTime, gridModel, vehicleIDs.at(j));
-                    gridModel.generateOneVehicleLoad(vehicleIDs.at(j));
+                group.clear();
+                {
+                    ProfileZone zone("charge rates");
+                    for(int j=i; j<std::min((int)gridModel.vehicles.size(), (int)(i+chargeRateGroupSize)); j++) {
+                        charger->setOneChargeRate(currTime, gridModel, vehicleIDs.at(j));
+                        gridModel.generateOneVehicleLoad(vehicleIDs.at(j));
+                        group.push_back(vehicleIDs.at(j));
+                    }
                 }
-                gridModel.runLoadFlow();
+                gridModel.runIncrementalLoadFlow(group);
             }
         }
 
@@ -221,21 +318,36 @@ void Simulator::run() {
         timingUpdate(lastCycleLength);
 
         // Log data
-        log.update(currTime, gridModel, charger, spotPrice);
+        {
+            ProfileZone zone("logging");
+            log.update(currTime, gridModel, spotPrice);
+            updateSummary();
+        }
         
         // Add optional user specified delay into cycle
         // while(utility::timediff(boost::posix_time::microsec_clock::local_time(), time_cycleStart) < config->getInt("intervaldelay"));
         
         // Estimate timing
-        lastCycleLength = boost::posix_time::microsec_clock::local_time() - timerCycle;
-        std::cout << "Cycle complete, took: " << utility::updateTimer(timerCycle) << std::endl;
+        lastCycleLength = boost::posix_time::microsec_clock::local_time() - cycleStart;
+        cycleStart += lastCycleLength;
+        std::cout << "Cycle complete" << std::endl;
 
         currTime.increment(config->getInt("simulationinterval"));
+        
+        // Periodically save full state, so simulation can be resumed from here
+        if(checkpointInterval > 0 && ++cyclesSinceCheckpoint >= checkpointInterval) {
+            ProfileZone zone("checkpoint");
+            saveCheckpoint();
+            cyclesSinceCheckpoint = 0;
+        }
     }
     
+    // Make sure all output is on file before reporting
+    log.finish();
+    
     // Simulation complete, provide some output, generate report.
     std::cout << "-------------------------------------------" << std::endl
-              << "Simulation complete, took " << utility::endTimer(timerRun) << std::endl;
+              << "Simulation complete" << std::endl;
     if(config->getBool("generatereport")) {
         std::cout << "Generating report ..." << std::endl; 
         loadflow->generateReport(log.getDir(), currTime.month, currTime.isWeekday(), config->getInt("simulationinterval"));
@@ -244,4 +356,105 @@ void Simulator::run() {
     std::cout << "-------------------------------------------" << std::endl; 
 }
 
+void Simulator::updateSummary() {
+    for(std::map<std::string,Household*>::iterator it = gridModel.households.begin(); it != gridModel.households.end(); ++it) {
+        summary.minHouseholdV = std::min(summary.minHouseholdV, it->second->V_RMS);
+        summary.maxHouseholdV = std::max(summary.maxHouseholdV, it->second->V_RMS);
+        summary.maxVoltageUnbalance = std::max(summary.maxVoltageUnbalance, it->second->V_unbalance);
+        if(it->second->V_RMS < gridModel.minVoltage)
+            summary.numUnderVoltage++;
+    }
+    
+    double householdLoads = gridModel.getSumHouseholdLoads();
+    double vehicleLoads = gridModel.getSumVehicleLoads();
+    summary.peakDemand = std::max(summary.peakDemand, householdLoads + vehicleLoads);
+    summary.vehicleEnergy += vehicleLoads/1000 * config->getInt("simulationinterval")/60.0;
+}
+
+SimulationSummary Simulator::getSummary() {
+    return summary;
+}
 
+std::string Simulator::getLogDir() {
+    return log.getDir();
+}
+
+void Simulator::saveCheckpoint() {
+    std::cout << "Saving checkpoint ...";
+    std::cout.flush();
+    
+    std::string file = log.getDir() + "checkpoint.bin";
+    std::string tempFile = file + ".tmp";
+    std::ofstream out(tempFile.c_str(), std::ios::binary);
+    
+    out.write(CHECKPOINT_ID, sizeof(CHECKPOINT_ID));
+    utility::writeBinary(out, CHECKPOINT_VERSION);
+    utility::writeBinary(out, seed);
+    currTime.saveState(out);
+    
+    utility::writeBinary(out, (int)vehicleIDs.size());
+    for(int i=0; i<vehicleIDs.size(); i++)
+        utility::writeBinary(out, vehicleIDs.at(i));
+    random.saveState(out);
+    
+    utility::writeBinary(out, summary.minHouseholdV);
+    utility::writeBinary(out, summary.maxHouseholdV);
+    utility::writeBinary(out, summary.numUnderVoltage);
+    utility::writeBinary(out, summary.peakDemand);
+    utility::writeBinary(out, summary.vehicleEnergy);
+    utility::writeBinary(out, summary.maxVoltageUnbalance);
+    
+    gridModel.saveState(out);
+    loadflow->saveState(out);
+    charger->saveState(out);
+    log.saveState(out);
+    out.close();
+    
+    // Only replace previous checkpoint once new one is complete
+    boost::filesystem::rename(tempFile, file);
+    std::cout << " OK" << std::endl;
+}
+
+void Simulator::readCheckpointHeader(std::istream &in) {
+    char id[sizeof(CHECKPOINT_ID)];
+    int version = 0;
+    
+    in.read(id, sizeof(id));
+    utility::readBinary(in, version);
+    if(!in || !std::equal(id, id+sizeof(id), CHECKPOINT_ID) || version != CHECKPOINT_VERSION) {
+        std::cout << "Error: not a checkpoint file, or written by a different version" << std::endl;
+        exit(1);
+    }
+    utility::readBinary(in, seed);
+}
+
+void Simulator::loadCheckpoint(std::istream &in) {
+    int numVehicles;
+    
+    currTime.loadState(in);
+    std::cout << "Resuming from checkpoint at " << currTime.toString() << " ..." << std::endl;
+    
+    utility::readBinary(in, numVehicles);
+    vehicleIDs.resize(numVehicles);
+    for(int i=0; i<numVehicles; i++)
+        utility::readBinary(in, vehicleIDs.at(i));
+    random.loadState(in);
+    
+    utility::readBinary(in, summary.minHouseholdV);
+    utility::readBinary(in, summary.maxHouseholdV);
+    utility::readBinary(in, summary.numUnderVoltage);
+    utility::readBinary(in, summary.peakDemand);
+    utility::readBinary(in, summary.vehicleEnergy);
+    utility::readBinary(in, summary.maxVoltageUnbalance);
+    
+    gridModel.loadState(in);
+    loadflow->loadState(in);
+    charger->loadState(in);
+    log.loadState(in);
+    
+    if(!in) {
+        std::cout << "Error: checkpoint file is incomplete" << std::endl;
+        exit(1);
+    }
+    std::cout << " - Checkpoint loaded OK" << std::endl << std::endl;
+}
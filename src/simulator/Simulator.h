@@ -40,9 +40,12 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "Config.h"
 #include "Logging.h"
 #include "../loadflow/MatlabInterface.h"
+#include "../loadflow/NativeInterface.h"
 #include "../loadflow/TestingInterface.h"
+#include "../loadflow/ModelFileParser.h"
 #include "../utility/Utility.h"
 #include "../utility/DateTime.h"
+#include "../utility/Profiler.h"
 #include "../gridmodel/GridModel.h"
 #include "../vehicle/TrafficModel.h"
 #include "../spotprice/SpotPrice.h"
@@ -60,6 +63,29 @@ POSSIBILITY OF SUCH DAMAGE.
 //#include "../charging/ChargingGameMechanism.h"
 
 
+/** Summary statistics of a full simulation run, e.g. for comparing the 
+  * members of an ensemble. */
+struct SimulationSummary {
+    /** Lowest RMS voltage at any household in any interval (V). */
+    double minHouseholdV;
+    
+    /** Highest RMS voltage at any household in any interval (V). */
+    double maxHouseholdV;
+    
+    /** Number of household-intervals with voltage below minimum voltage. */
+    int numUnderVoltage;
+    
+    /** Highest total household and vehicle demand in any interval (W). */
+    double peakDemand;
+    
+    /** Total energy used for vehicle charging (kWh). */
+    double vehicleEnergy;
+    
+    /** Highest voltage unbalance at any household in any interval (%). */
+    double maxVoltageUnbalance;
+};
+
+
 /** The outer Simulator loop.
  * This class defines the main outer loop of the entire simulation.
  * It loads all components, starts the simulation, interrupts or delays the 
@@ -124,6 +150,34 @@ private:
     
     /** Local pointer to config object */
     Config *config;
+    
+    /** Master seed from which all random streams of this simulation are derived */
+    unsigned int seed;
+    
+    /** Random stream of simulator (e.g. for order of charge rate updates) */
+    RandomStream random;
+    
+    /** Summary statistics, updated every cycle */
+    SimulationSummary summary;
+    
+    /** Number of cycles between checkpoints (0 for none) */
+    int checkpointInterval;
+    
+    /** Load all components.  Demand profiles are assigned using the given
+      * demand model, log is written to given directory (new one if empty). */
+    void load(HouseholdDemandModel &demandModel, std::string logDir);
+    
+    /** Update summary statistics following a cycle */
+    void updateSummary();
+    
+    /** Write full simulation state to checkpoint file in log directory */
+    void saveCheckpoint();
+    
+    /** Check that stream is a checkpoint file, read seed from it */
+    void readCheckpointHeader(std::istream &in);
+    
+    /** Restore simulation state from (rest of) checkpoint file */
+    void loadCheckpoint(std::istream &in);
 
     /** A simple timing update to give the user an indication of how much
       * longer the simulation will run for. */
@@ -134,12 +188,29 @@ public:
       * Accepts config object to set configuration parameters.*/
     Simulator(Config* config);
     
+    /** Constructor for one member of an ensemble of simulations.  Demand 
+      * profiles, travel records and network model are taken from the given 
+      * (shared) models rather than read again.  Log output goes to the
+      * given directory, all randomness is derived from the given seed. */
+    Simulator(Config* config, 
+              HouseholdDemandModel &demandModel, 
+              TrafficModel &trafficModel, 
+              ModelFileParser* parser,
+              std::string logDir,
+              unsigned int seed);
+    
     /** Destructor*/
     virtual ~Simulator();
     
     /** Start the simulation! */
     void run();
     
+    /** Return summary statistics of the simulation so far */
+    SimulationSummary getSummary();
+    
+    /** Return directory that log output is written to */
+    std::string getLogDir();
+    
 };
 
 #endif	/* SIMULATOR_H */
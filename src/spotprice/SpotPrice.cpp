@@ -48,7 +48,7 @@ SpotPrice::SpotPrice(Config* config) {
 SpotPrice::~SpotPrice() {
 }
 
-double SpotPrice::findPriceAt(DateTime datetime) {
+double SpotPrice::findPriceAt(DateTime datetime) const {
     // Generate correct filename
     std::stringstream ss;
     ss << dataDir << "DATA" << datetime.year;
@@ -84,6 +84,6 @@ void SpotPrice::update(DateTime datetime) {
     price = findPriceAt(datetime);
 }
 
-void SpotPrice::display() {
+void SpotPrice::display() const {
     std::cout << "Spot price      : " << std::setw(7) << std::right << std::setiosflags(std::ios::fixed) << std::setprecision(2) << price << std::endl;
 }
\ No newline at end of file
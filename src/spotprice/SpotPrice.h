@@ -63,13 +63,13 @@ public:
     virtual ~SpotPrice();
     
     /** Return price at given date and time */
-    double findPriceAt(DateTime datetime);
+    double findPriceAt(DateTime datetime) const;
     
     /** Update price to give date and time */
     void update(DateTime datetime);
     
     /** Display */
-    void display();
+    void display() const;
 
 };
 
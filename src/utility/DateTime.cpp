@@ -331,6 +331,37 @@ int DateTime::totalMinutes() {
     return (hour*60 + minute);
 }
 
+long DateTime::minutesSinceEpoch() {
+    // Days since 1 Jan 1970 of proleptic Gregorian calendar, counting years
+    // from March so that leap days come last
+    long y = year - (month <= 2 ? 1 : 0);
+    long era = (y >= 0 ? y : y-399) / 400;
+    long yearOfEra = y - era*400;
+    long dayOfYear = (153*(month > 2 ? month-3 : month+9) + 2)/5 + day-1;
+    long dayOfEra = yearOfEra*365 + yearOfEra/4 - yearOfEra/100 + dayOfYear;
+    long days = era*146097 + dayOfEra - 719468;
+    
+    return days*1440 + totalMinutes();
+}
+
+void DateTime::saveState(std::ostream &out) {
+    utility::writeBinary(out, hour);
+    utility::writeBinary(out, minute);
+    utility::writeBinary(out, day);
+    utility::writeBinary(out, month);
+    utility::writeBinary(out, year);
+    utility::writeBinary(out, weekday);
+}
+
+void DateTime::loadState(std::istream &in) {
+    utility::readBinary(in, hour);
+    utility::readBinary(in, minute);
+    utility::readBinary(in, day);
+    utility::readBinary(in, month);
+    utility::readBinary(in, year);
+    utility::readBinary(in, weekday);
+}
+
 void DateTime::display() {
     std::cout << toString() << std::endl;
 }
@@ -112,6 +112,9 @@ public:
     /** Returns total minutes passed in this day since midnight */
     int  totalMinutes();
     
+    /** Returns total minutes passed since midnight, 1 January 1970 */
+    long minutesSinceEpoch();
+    
     /** Returns number of intervals different to other, using specified interval size */
     long diffTotal(DateTime other, int numMins);
     
@@ -124,6 +127,12 @@ public:
     /** Displays full date and time */
     void display();
     
+    /** Write state to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read state from checkpoint. */
+    void loadState(std::istream &in);
+    
     /** Returns string value of full date and time */
     std::string toString();
     
@@ -0,0 +1,244 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "Profiler.h"
+
+namespace {
+    
+    /** Aggregated timings of one zone (in ms). */
+    struct ZoneStats {
+        RunningStats time;
+        P2Quantile median;
+        P2Quantile p99;
+        ZoneStats() : median(0.5), p99(0.99) {}
+    };
+    
+    /** Timings of one zone merged across threads.  Quantiles are averages of
+      * each thread's estimate, weighted by count (exact for one thread). */
+    struct MergedStats {
+        RunningStats time;
+        double median;
+        double p99;
+        MergedStats() : median(0), p99(0) {}
+    };
+    
+    /** One trace event (times in microseconds since profiler was enabled). */
+    struct TraceEvent {
+        const char* name;
+        long start;
+        long duration;
+        int thread;
+    };
+    
+    /** Zones currently entered by one thread, and timings and trace events
+      * collected by it.  Threads only ever lock their own mutex (uncontended
+      * until results are merged). */
+    struct ThreadZones {
+        int thread;
+        std::vector<std::string> paths;
+        std::vector<const char*> names;
+        std::vector<boost::posix_time::ptime> starts;
+        
+        boost::mutex mutex;
+        std::map<std::string, ZoneStats> zones;
+        std::vector<TraceEvent> events;
+    };
+    
+    bool enabled = false;
+    bool tracing = false;
+    boost::posix_time::ptime startTime;
+    
+    /** Trace events recorded (or dropped, beyond maxEvents) by all threads. */
+    long maxEvents = 0;
+    boost::atomic<long> numEvents(0);
+    
+    /** Zones of all threads that have entered one.  These are kept after
+      * their threads exit, until results are written.  Guarded by mutex,
+      * which is only taken when a thread enters its first zone. */
+    boost::mutex mutex;
+    std::vector<ThreadZones*> allThreads;
+    
+    // Zones of a thread are owned by allThreads, not deleted at thread exit
+    void keepThreadZones(ThreadZones*) {}
+    boost::thread_specific_ptr<ThreadZones> threadZones(keepThreadZones);
+    
+    /** Merge timings of all threads, by zone path. */
+    void mergeZones(std::map<std::string, MergedStats> &merged) {
+        boost::mutex::scoped_lock lock(mutex);
+        for(int i=0; i<allThreads.size(); i++) {
+            boost::mutex::scoped_lock threadLock(allThreads[i]->mutex);
+            std::map<std::string, ZoneStats> &zones = allThreads[i]->zones;
+            for(std::map<std::string, ZoneStats>::iterator it = zones.begin(); it != zones.end(); ++it) {
+                MergedStats &stats = merged[it->first];
+                long before = stats.time.getCount();
+                long count = it->second.time.getCount();
+                stats.time.merge(it->second.time);
+                stats.median = (stats.median*before + it->second.median.get()*count) / (before + count);
+                stats.p99 = (stats.p99*before + it->second.p99.get()*count) / (before + count);
+            }
+        }
+    }
+}
+
+
+void Profiler::enable(bool trace, long maxEventsIn) {
+    enabled = true;
+    tracing = trace;
+    maxEvents = maxEventsIn;
+    startTime = boost::posix_time::microsec_clock::universal_time();
+}
+
+bool Profiler::isEnabled() {
+    return enabled;
+}
+
+void Profiler::begin(const char* name) {
+    ThreadZones* current = threadZones.get();
+    if(current == NULL) {
+        current = new ThreadZones;
+        boost::mutex::scoped_lock lock(mutex);
+        allThreads.push_back(current);
+        current->thread = allThreads.size();
+        threadZones.reset(current);
+    }
+    
+    if(current->paths.empty())
+        current->paths.push_back(name);
+    else
+        current->paths.push_back(current->paths.back() + "/" + name);
+    current->names.push_back(name);
+    current->starts.push_back(boost::posix_time::microsec_clock::universal_time());
+}
+
+void Profiler::end() {
+    ThreadZones* current = threadZones.get();
+    if(current == NULL || current->paths.empty())
+        return;
+    
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    long duration = (now - current->starts.back()).total_microseconds();
+    
+    {
+        boost::mutex::scoped_lock lock(current->mutex);
+        ZoneStats &stats = current->zones[current->paths.back()];
+        stats.time.add(duration / 1000.0);
+        stats.median.add(duration / 1000.0);
+        stats.p99.add(duration / 1000.0);
+        
+        if(tracing && numEvents.fetch_add(1, boost::memory_order_relaxed) < maxEvents) {
+            TraceEvent event;
+            event.name = current->names.back();
+            event.start = (current->starts.back() - startTime).total_microseconds();
+            event.duration = duration;
+            event.thread = current->thread;
+            current->events.push_back(event);
+        }
+    }
+    
+    current->paths.pop_back();
+    current->names.pop_back();
+    current->starts.pop_back();
+}
+
+void Profiler::display() {
+    if(!enabled)
+        return;
+    
+    std::map<std::string, MergedStats> zones;
+    mergeZones(zones);
+    std::cout << "Profile (times in ms)" << std::endl
+              << "  Zone                                      Count      Total       P50       P99" << std::endl
+              << "  -------------------------------------------------------------------------------" << std::endl;
+    for(std::map<std::string, MergedStats>::iterator it = zones.begin(); it != zones.end(); ++it) {
+        // Indent by depth, show name only
+        int depth = std::count(it->first.begin(), it->first.end(), '/');
+        std::string name = std::string(2*depth, ' ') + it->first.substr(it->first.rfind('/') + 1);
+        std::cout << "  " << std::setw(40) << std::left << name.substr(0, 40)
+                  << std::setw(7) << std::right << it->second.time.getCount()
+                  << std::setiosflags(std::ios::fixed) << std::setprecision(1)
+                  << std::setw(11) << it->second.time.getCount() * it->second.time.getMean()
+                  << std::setprecision(3)
+                  << std::setw(10) << it->second.median
+                  << std::setw(10) << it->second.p99 << std::endl;
+    }
+    std::cout << std::resetiosflags(std::ios::fixed) << std::setprecision(6);
+}
+
+void Profiler::write(std::string directory) {
+    if(!enabled)
+        return;
+    
+    std::map<std::string, MergedStats> zones;
+    mergeZones(zones);
+    std::ofstream outfile;
+    
+    outfile.open((directory + "profile.csv").c_str());
+    outfile << "Zone, Count, Total (ms), Mean (ms), P50 (ms), P99 (ms), Max (ms)" << std::endl;
+    for(std::map<std::string, MergedStats>::iterator it = zones.begin(); it != zones.end(); ++it)
+        outfile << it->first << ", "
+                << it->second.time.getCount() << ", "
+                << it->second.time.getCount() * it->second.time.getMean() << ", "
+                << it->second.time.getMean() << ", "
+                << it->second.median << ", "
+                << it->second.p99 << ", "
+                << it->second.time.getMax() << std::endl;
+    outfile.close();
+    
+    if(!tracing)
+        return;
+    
+    outfile.open((directory + "trace.json").c_str());
+    outfile << "{\"traceEvents\":[" << std::endl;
+    bool first = true;
+    boost::mutex::scoped_lock lock(mutex);
+    for(int t=0; t<allThreads.size(); t++) {
+        boost::mutex::scoped_lock threadLock(allThreads[t]->mutex);
+        std::vector<TraceEvent> &events = allThreads[t]->events;
+        for(int i=0; i<events.size(); i++) {
+            if(!first)
+                outfile << "," << std::endl;
+            first = false;
+            outfile << "{\"name\":\"" << events[i].name << "\",\"cat\":\"possim\",\"ph\":\"X\","
+                    << "\"ts\":" << events[i].start << ",\"dur\":" << events[i].duration << ","
+                    << "\"pid\":1,\"tid\":" << events[i].thread << "}";
+        }
+    }
+    outfile << std::endl;
+    outfile << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    outfile.close();
+    
+    if(numEvents > maxEvents)
+        std::cout << "Trace limited to first " << maxEvents << " events, " 
+                  << numEvents - maxEvents << " dropped (see profileevents)" << std::endl;
+}
@@ -0,0 +1,109 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef PROFILER_H
+#define	PROFILER_H
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "Statistics.h"
+
+
+/** Collects the time spent in named zones of the code (see ProfileZone).
+  * Zones nest:  a zone is identified by its path, e.g. "interval/load flow/
+  * runSim", and timings are aggregated per path (count, total, median, 99th
+  * percentile, maximum) across the whole run and all threads.  Each thread
+  * collects its own timings, which are only merged when displayed or 
+  * written, so threads do not contend on zone exit.  Optionally,
+  * every zone is also recorded as an event in Chrome trace format (view in
+  * chrome://tracing or Perfetto).  Disabled by default, in which case zones
+  * cost next to nothing. */
+class Profiler {
+public:
+    /** Enable aggregation of zone timings and, optionally, trace events. 
+      * At most maxEvents trace events are recorded (across all threads),
+      * later ones are dropped. */
+    static void enable(bool trace, long maxEvents);
+    
+    /** True if zones are being timed. */
+    static bool isEnabled();
+    
+    /** Enter zone of given name (nested in current zone of this thread). */
+    static void begin(const char* name);
+    
+    /** Leave current zone of this thread. */
+    static void end();
+    
+    /** Display aggregated zone timings. */
+    static void display();
+    
+    /** Write aggregated zone timings (profile.csv) and, if enabled, trace 
+      * events (trace.json) to given directory. */
+    static void write(std::string directory);
+};
+
+
+/** Times the scope it is declared in as a zone of the Profiler, e.g.
+  * 
+  *     { ProfileZone zone("runSim");  loadflow->runSim(); }
+  */
+class ProfileZone {
+public:
+    /** Enter zone (name must outlive the zone, e.g. a string literal). */
+    ProfileZone(const char* name) {
+        if(Profiler::isEnabled())
+            Profiler::begin(name);
+    }
+    
+    /** Leave zone. */
+    ~ProfileZone() {
+        if(Profiler::isEnabled())
+            Profiler::end();
+    }
+    
+private:
+    ProfileZone(const ProfileZone&);
+    ProfileZone& operator=(const ProfileZone&);
+};
+
+#endif	/* PROFILER_H */
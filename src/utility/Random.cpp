@@ -0,0 +1,121 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "Random.h"
+
+// Increment between successive counter values (golden ratio, as SplitMix64)
+static const boost::uint64_t GAMMA = 0x9E3779B97F4A7C15ULL;
+
+RandomStream::RandomStream() {
+    key = 0;
+    counter = 0;
+}
+
+RandomStream::RandomStream(boost::uint64_t k) {
+    key = k;
+    counter = 0;
+}
+
+RandomStream::RandomStream(unsigned int masterSeed, std::string entity, int id) {
+    // FNV-1a hash of entity name (stable across platforms, unlike boost::hash)
+    boost::uint64_t h = 0xCBF29CE484222325ULL;
+    for(size_t i=0; i<entity.length(); i++) {
+        h ^= (unsigned char)entity[i];
+        h *= 0x100000001B3ULL;
+    }
+    key = mix(mix(masterSeed + h*GAMMA) ^ (boost::uint64_t)id);
+    counter = 0;
+}
+
+RandomStream::~RandomStream() {
+}
+
+RandomStream RandomStream::substream(boost::uint64_t n) {
+    return RandomStream(mix(key ^ mix(n + GAMMA)));
+}
+
+boost::uint64_t RandomStream::next() {
+    counter++;
+    return mix(key + counter*GAMMA);
+}
+
+double RandomStream::uniform() {
+    // Top 53 bits give all doubles in [0,1) with spacing 2^-53
+    return (next() >> 11) * (1.0/9007199254740992.0);
+}
+
+double RandomStream::uniform(double min, double max) {
+    return min + uniform() * (max-min);
+}
+
+int RandomStream::index(int n) {
+    return (int)(uniform() * n);
+}
+
+int RandomStream::operator()(int n) {
+    return index(n);
+}
+
+// Box-Muller transform;  uses two values of the stream
+double RandomStream::normal(double mean, double sigma) {
+    double u1 = 1.0 - uniform();
+    double u2 = uniform();
+    return mean + sigma * std::sqrt(-2.0*std::log(u1)) * std::cos(2*M_PI*u2);
+}
+
+double RandomStream::normal(double mean, double sigma, double min, double max) {
+    double curr = normal(mean, sigma);
+    if(curr < min || curr > max) curr = mean;
+    return curr;
+}
+
+double RandomStream::normal(double *vars) {
+    return normal(vars[0], vars[1], vars[2], vars[3]);
+}
+
+void RandomStream::saveState(std::ostream &out) {
+    out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    out.write(reinterpret_cast<const char*>(&counter), sizeof(counter));
+}
+
+void RandomStream::loadState(std::istream &in) {
+    in.read(reinterpret_cast<char*>(&key), sizeof(key));
+    in.read(reinterpret_cast<char*>(&counter), sizeof(counter));
+}
+
+boost::uint64_t RandomStream::mix(boost::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
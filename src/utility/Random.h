@@ -0,0 +1,117 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef RANDOM_H
+#define	RANDOM_H
+
+#include <string>
+#include <iostream>
+#include <cmath>
+#include <boost/cstdint.hpp>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846264338327950288
+#endif /*M_PI*/
+
+
+/** A counter-based stream of random numbers.  Each stream is identified by a 
+  * key, derived from the simulation's master seed and the entity (household,
+  * vehicle, model) the stream belongs to;  the n-th number of a stream is a 
+  * hash of its key and n.  Streams of different entities are therefore 
+  * independent of each other and of the order in which entities are visited,
+  * and a stream can be split into further independent streams (e.g. one per 
+  * simulation interval) without drawing from it. */
+class RandomStream {
+private:
+    /** Identifies this stream. */
+    boost::uint64_t key;
+    
+    /** Number of values drawn so far. */
+    boost::uint64_t counter;
+    
+public:
+    /** Constructor.  Stream with key 0. */
+    RandomStream();
+    
+    /** Constructor.  Stream with given key. */
+    RandomStream(boost::uint64_t key);
+    
+    /** Constructor.  Stream of the given entity (e.g. "household", NMI) in a
+      * simulation having the given master seed. */
+    RandomStream(unsigned int masterSeed, std::string entity, int id);
+    
+    /** Destructor */
+    ~RandomStream();
+    
+    /** Return independent stream number n derived from this one.  Does not
+      * draw from this stream. */
+    RandomStream substream(boost::uint64_t n);
+    
+    /** Return next raw 64-bit value. */
+    boost::uint64_t next();
+    
+    /** Return next value, uniformly distributed in [0,1). */
+    double uniform();
+    
+    /** Return next value, uniformly distributed in [min,max). */
+    double uniform(double min, double max);
+    
+    /** Return next integer, uniformly distributed in [0,n). */
+    int index(int n);
+    
+    /** Same as index(n), so that a stream can be passed to std::random_shuffle. */
+    int operator()(int n);
+    
+    /** Return next value, normally distributed. */
+    double normal(double mean, double sigma);
+    
+    /** Return next value, normally distributed;  values below min or above
+      * max are set to mean. */
+    double normal(double mean, double sigma, double min, double max);
+    
+    /** As above, with 4-tuple input (mean, sigma, min, max). */
+    double normal(double *vars);
+    
+    /** Write key and position of stream to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read key and position of stream from checkpoint. */
+    void loadState(std::istream &in);
+    
+private:
+    /** Scramble bits of x (SplitMix64 finaliser). */
+    static boost::uint64_t mix(boost::uint64_t x);
+};
+
+#endif	/* RANDOM_H */
@@ -0,0 +1,223 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include "Statistics.h"
+#include "Utility.h"
+
+
+RunningStats::RunningStats() {
+    count = 0;
+    mean = 0;
+    M2 = 0;
+    min = std::numeric_limits<double>::infinity();
+    max = -std::numeric_limits<double>::infinity();
+}
+
+void RunningStats::add(double x) {
+    count++;
+    double delta = x - mean;
+    mean += delta / count;
+    M2 += delta * (x - mean);
+    
+    if(x < min)
+        min = x;
+    if(x > max)
+        max = x;
+}
+
+void RunningStats::merge(const RunningStats &other) {
+    if(other.count == 0)
+        return;
+    
+    // Chan et al.'s pairwise combination of mean and M2
+    long total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    M2 += other.M2 + delta * delta * count * other.count / total;
+    count = total;
+    
+    if(other.min < min)
+        min = other.min;
+    if(other.max > max)
+        max = other.max;
+}
+
+long RunningStats::getCount() {
+    return count;
+}
+
+double RunningStats::getMin() {
+    return min;
+}
+
+double RunningStats::getMax() {
+    return max;
+}
+
+double RunningStats::getMean() {
+    return mean;
+}
+
+double RunningStats::getVariance() {
+    if(count < 2)
+        return 0;
+    return M2 / (count - 1);
+}
+
+double RunningStats::getStdDev() {
+    return sqrt(getVariance());
+}
+
+void RunningStats::saveState(std::ostream &out) {
+    utility::writeBinary(out, count);
+    utility::writeBinary(out, mean);
+    utility::writeBinary(out, M2);
+    utility::writeBinary(out, min);
+    utility::writeBinary(out, max);
+}
+
+void RunningStats::loadState(std::istream &in) {
+    utility::readBinary(in, count);
+    utility::readBinary(in, mean);
+    utility::readBinary(in, M2);
+    utility::readBinary(in, min);
+    utility::readBinary(in, max);
+}
+
+
+P2Quantile::P2Quantile(double quantile) {
+    p = quantile;
+    count = 0;
+    for(int i=0; i<5; i++) {
+        q[i] = 0;
+        n[i] = i;
+    }
+    desired[0] = 0;
+    desired[1] = 2*p;
+    desired[2] = 4*p;
+    desired[3] = 2 + 2*p;
+    desired[4] = 4;
+    increment[0] = 0;
+    increment[1] = p/2;
+    increment[2] = p;
+    increment[3] = (1+p)/2;
+    increment[4] = 1;
+}
+
+void P2Quantile::add(double x) {
+    int k;
+    
+    // First five values initialise the markers
+    if(count < 5) {
+        q[count++] = x;
+        if(count == 5)
+            std::sort(q, q+5);
+        return;
+    }
+    count++;
+    
+    // Find cell k containing x, adjust extreme markers if needed
+    if(x < q[0]) {
+        q[0] = x;
+        k = 0;
+    }
+    else if(x >= q[4]) {
+        q[4] = x;
+        k = 3;
+    }
+    else {
+        k = 0;
+        while(x >= q[k+1])
+            k++;
+    }
+    
+    for(int i=k+1; i<5; i++)
+        n[i]++;
+    for(int i=0; i<5; i++)
+        desired[i] += increment[i];
+    
+    // Move middle markers towards their desired positions, if off by more than one
+    for(int i=1; i<4; i++) {
+        double d = desired[i] - n[i];
+        if((d >= 1 && n[i+1] - n[i] > 1) || (d <= -1 && n[i-1] - n[i] < -1)) {
+            int sign = (d > 0) ? 1 : -1;
+            double prediction = parabolic(i, sign);
+            if(q[i-1] < prediction && prediction < q[i+1])
+                q[i] = prediction;
+            else
+                q[i] = linear(i, sign);
+            n[i] += sign;
+        }
+    }
+}
+
+double P2Quantile::get() {
+    if(count == 0)
+        return 0;
+    if(count >= 5)
+        return q[2];
+    
+    double sorted[5];
+    std::copy(q, q+count, sorted);
+    std::sort(sorted, sorted+count);
+    return sorted[(int)(p*(count-1) + 0.5)];
+}
+
+double P2Quantile::parabolic(int i, double d) {
+    return q[i] + d / (n[i+1] - n[i-1]) * 
+                 ((n[i] - n[i-1] + d) * (q[i+1] - q[i]) / (n[i+1] - n[i]) + 
+                  (n[i+1] - n[i] - d) * (q[i] - q[i-1]) / (n[i] - n[i-1]));
+}
+
+double P2Quantile::linear(int i, int d) {
+    return q[i] + d * (q[i+d] - q[i]) / (n[i+d] - n[i]);
+}
+
+void P2Quantile::saveState(std::ostream &out) {
+    utility::writeBinary(out, p);
+    utility::writeBinary(out, count);
+    utility::writeBinary(out, q);
+    utility::writeBinary(out, n);
+    utility::writeBinary(out, desired);
+    utility::writeBinary(out, increment);
+}
+
+void P2Quantile::loadState(std::istream &in) {
+    utility::readBinary(in, p);
+    utility::readBinary(in, count);
+    utility::readBinary(in, q);
+    utility::readBinary(in, n);
+    utility::readBinary(in, desired);
+    utility::readBinary(in, increment);
+}
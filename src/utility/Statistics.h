@@ -0,0 +1,128 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#ifndef STATISTICS_H
+#define	STATISTICS_H
+
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+
+/** Running statistics of a stream of values (count, minimum, maximum, mean
+  * and variance), updated one value at a time using Welford's method. */
+class RunningStats {
+private:
+    long count;
+    double mean;
+    
+    /** Sum of squared differences from the mean. */
+    double M2;
+    
+    double min;
+    double max;
+    
+public:
+    /** Constructor, no values. */
+    RunningStats();
+    
+    /** Add value. */
+    void add(double x);
+    
+    /** Add all values of other, as if they had been added one by one. */
+    void merge(const RunningStats &other);
+    
+    long getCount();
+    double getMin();
+    double getMax();
+    double getMean();
+    
+    /** Sample variance (0 for fewer than two values). */
+    double getVariance();
+    
+    double getStdDev();
+    
+    /** Write state to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read state from checkpoint. */
+    void loadState(std::istream &in);
+};
+
+
+/** Estimates a quantile of a stream of values without storing them, using
+  * the P-squared algorithm (Jain and Chlamtac, 1985):  five markers are kept 
+  * at the minimum, the quantile, the maximum, and half-way between, and 
+  * their heights are adjusted as each value arrives. */
+class P2Quantile {
+private:
+    /** Quantile to estimate, in [0,1]. */
+    double p;
+    
+    long count;
+    
+    /** Marker heights. */
+    double q[5];
+    
+    /** Marker positions, and their desired positions and increments. */
+    double n[5];
+    double desired[5];
+    double increment[5];
+    
+public:
+    /** Constructor, estimating given quantile (e.g. 0.05 for 5th percentile). */
+    P2Quantile(double p);
+    
+    /** Add value. */
+    void add(double x);
+    
+    /** Current estimate of quantile (exact for up to five values). */
+    double get();
+    
+    /** Write state to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read state from checkpoint. */
+    void loadState(std::istream &in);
+    
+private:
+    /** Piecewise-parabolic prediction of height of marker i moved by d. */
+    double parabolic(int i, double d);
+    
+    /** Linear prediction of height of marker i moved by d. */
+    double linear(int i, int d);
+};
+
+#endif	/* STATISTICS_H */
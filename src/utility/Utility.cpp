@@ -142,11 +142,11 @@ void utility::tokenize(const std::string& str, std::vector<std::string>& tokens,
 // Implements Fisher-Yates shuffle 
 //(see http://en.wikipedia.org/wiki/Fisher%E2%80%93Yates_shuffle
 // and http://ideone.com/3A3cv)
-std::vector<int>::iterator utility::random_unique(std::vector<int>::iterator begin, std::vector<int>::iterator end, size_t num_random) {
+std::vector<int>::iterator utility::random_unique(std::vector<int>::iterator begin, std::vector<int>::iterator end, size_t num_random, RandomStream &random) {
     size_t left = std::distance(begin, end);
     while (num_random--) {
         std::vector<int>::iterator r = begin;
-        std::advance(r, rand()%left);
+        std::advance(r, random.index(left));
         std::swap(*begin, *r);
         ++begin;
         --left;
@@ -154,40 +154,6 @@ std::vector<int>::iterator utility::random_unique(std::vector<int>::iterator beg
     return begin;
 }
 
-// Returns random number according to random distribution having mean and standard dev sigma
-// values above max and below min are set to mean
-double utility::randomNormal(double mean, double sigma, double min, double max) {
-    typedef boost::mt19937                     ENG;    // Mersenne Twister
-    typedef boost::normal_distribution<double> DIST;   // Normal Distribution
-    typedef boost::variate_generator<ENG,DIST> GEN;    // Variate generator
-    boost::posix_time::ptime time = boost::posix_time::microsec_clock::local_time();
-    boost::posix_time::time_duration duration(time.time_of_day());
-
-    ENG  eng(duration.total_milliseconds());
-    DIST dist(mean,sigma);
-    GEN  gen(eng,dist);
- 
-    double curr = gen();
-    if(curr < min || curr > max) curr = mean;
-
-    return curr;
-}
-
-double utility::randomNormal(double *vars) {
-    return randomNormal(vars[0], vars[1], vars[2], vars[3]);
-}
-
-
-double utility::randomUniform() {
-    return (double)rand()/RAND_MAX;
-}
-
-// Return uniform random number, scaled to range (min, max)
-double utility::randomUniform(double min, double max) {
-    double f = (double)rand()/RAND_MAX;
-    return min + f * (max-min);
-}
-
 // Strip quotation marks from around a given string
 std::string utility::stripQuotations(std::string stringIn) {
     std::string::size_type start = stringIn.find_first_of("\"");
@@ -216,4 +182,18 @@ std::vector<std::string> utility::getAllFileNames(std::string directory) {
         
     return fileNameList;
 }
-    
\ No newline at end of file
+    
+
+void utility::writeBinary(std::ostream &out, const std::string &value) {
+    int length = value.length();
+    out.write(reinterpret_cast<const char*>(&length), sizeof(int));
+    out.write(value.data(), length);
+}
+
+void utility::readBinary(std::istream &in, std::string &value) {
+    int length = 0;
+    in.read(reinterpret_cast<char*>(&length), sizeof(int));
+    value.resize(length);
+    if(length > 0)
+        in.read(&value[0], length);
+}
@@ -46,14 +46,12 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <algorithm>
 #include <cstdlib>
 #include <cmath>
-#include <boost/random/mersenne_twister.hpp>
-#include <boost/random/normal_distribution.hpp>
-#include <boost/random/variate_generator.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
 
 #include "DateTime.h"
 #include "Power.h"
+#include "Random.h"
 
 enum Phase{A=0, B=1, C=2, N=3};
 
@@ -102,19 +100,7 @@ namespace utility {
     void tokenize(const std::string& str, std::vector<std::string>& tokens, std::string del);
     
     /** Return random ordering of components of a vector, using Fisher-Yates shuffle */
-    std::vector<int>::iterator random_unique(std::vector<int>::iterator begin, std::vector<int>::iterator end, size_t num_random);
-    
-    /** Return random var according to normal distribution */
-    double randomNormal(double mean, double sigma, double min, double max);
-    
-    /** Return random var according to normal distribution, 4-tuple input */
-    double randomNormal(double *vars);
-    
-    /** Return random var according to uniform distribution */
-    double randomUniform();
-    
-    /** Return random var according to uniform distribution scaled by range (min, max) */
-    double randomUniform(double min, double max);
+    std::vector<int>::iterator random_unique(std::vector<int>::iterator begin, std::vector<int>::iterator end, size_t num_random, RandomStream &random);
     
     /** Strip quotation marks from a given string (i.e. turn "examplestring" into examplestring) */
     std::string stripQuotations(std::string stringIn);
@@ -125,6 +111,22 @@ namespace utility {
     /** Get all filenames in a given directory (for demand profile input) */
     std::vector<std::string> getAllFileNames(std::string directory);
     
+    /** Write a value in binary form (e.g. to a checkpoint file) */
+    template<class T> void writeBinary(std::ostream &out, const T &value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    
+    /** Read a value in binary form (e.g. from a checkpoint file) */
+    template<class T> void readBinary(std::istream &in, T &value) {
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    }
+    
+    /** Write a string in binary form (length, followed by characters) */
+    void writeBinary(std::ostream &out, const std::string &value);
+    
+    /** Read a string in binary form (length, followed by characters) */
+    void readBinary(std::istream &in, std::string &value);
+    
 
 // Please leave the below comment for doxygen documentation
 /** @} End of Utility group */
@@ -53,6 +53,7 @@ TrafficModel::TrafficModel(Config* config) {
     vehicleRecord_t vehicleRecord;
     travelPair_t travelPair;
     int numWeekend = 0, numWeekday = 0;
+    travelRecords.reset(new std::vector<vehicleRecord_t>());
     
     // Get correct record
     while(getline(infile, line)) {
@@ -76,12 +77,12 @@ TrafficModel::TrafficModel(Config* config) {
             numWeekday++;
         }
         
-        travelRecords.push_back(vehicleRecord);
+        travelRecords->push_back(vehicleRecord);
     }
     
     infile.close();
     
-    std::cout << std::endl << " - found " << travelRecords.size() 
+    std::cout << std::endl << " - found " << travelRecords->size() 
               << " vehicle records (" 
               << numWeekday << " weekday, " 
               << numWeekend << " weekend) ... "
@@ -90,8 +91,6 @@ TrafficModel::TrafficModel(Config* config) {
     home2away = 0;
     away2home = 0;
     
-    srand((unsigned int)(time(NULL)));
-    
     // Store model type and path to file
     modelType = config->getString("trafficmodel");
     file_travelProfiles = config->getString("trafficmodelfile");
@@ -147,7 +146,7 @@ void TrafficModel::assignVehicleRecords(DateTime datetime, std::map<std::string,
         for(std::map<std::string,Vehicle*>::iterator it = vehicles.begin(); it != vehicles.end(); ++it) {
             thisRecordName = travelRecordList.at(counter);
 
-            for(std::vector<vehicleRecord_t>::iterator it2 = travelRecords.begin(); it2 != travelRecords.end(); ++it2)
+            for(std::vector<vehicleRecord_t>::iterator it2 = travelRecords->begin(); it2 != travelRecords->end(); ++it2)
                 if(it2->name == thisRecordName) {
                     it->second->travelProfile = *it2;
                     break;
@@ -169,11 +168,11 @@ void TrafficModel::assignVehicleRecords(DateTime datetime, std::map<std::string,
 
             // Generate random number until either weekend or weekday (as desired) is found
             // (WARNING:  could loop endlessly, should fix in future)
-            randomIndex = rand()%travelRecords.size();
-            while(travelRecords.at(randomIndex).isWeekday != datetime.isWeekday())
-                randomIndex = rand()%travelRecords.size();
+            randomIndex = it->second->random.index(travelRecords->size());
+            while(travelRecords->at(randomIndex).isWeekday != datetime.isWeekday())
+                randomIndex = it->second->random.index(travelRecords->size());
 
-            it->second->travelProfile = travelRecords.at(randomIndex); 
+            it->second->travelProfile = travelRecords->at(randomIndex); 
         }
     }
     
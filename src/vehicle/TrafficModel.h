@@ -44,6 +44,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <stdio.h>
 #include <stdlib.h>
 #include <iomanip>
+#include <boost/shared_ptr.hpp>
 
 #include "../simulator/Config.h"
 #include "../vehicle/Vehicle.h"
@@ -56,8 +57,9 @@ class TrafficModel {
     
 private:  
     /** Vector of travel records.  Each record has the format:
-      * <vehicleID>, <dayOfWeek>, <timeDeparted>, <timeArrived>, <distanceDriven>, <timeDeparted>, <timeArrived>, <distanceDriven>,  etc...*/
-    std::vector<vehicleRecord_t> travelRecords;
+      * <vehicleID>, <dayOfWeek>, <timeDeparted>, <timeArrived>, <distanceDriven>, <timeDeparted>, <timeArrived>, <distanceDriven>,  etc...
+      * Read-only once loaded, and shared by all copies of this traffic model. */
+    boost::shared_ptr<std::vector<vehicleRecord_t> > travelRecords;
     
     /** Keep track of transitions */
     int home2away;
@@ -35,8 +35,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "Vehicle.h"
 
 
-Vehicle::Vehicle(Config* config, int nmi, std::string newName, std::string parentHH) :
-    battery(config) {
+Vehicle::Vehicle(Config* config, int nmi, std::string newName, std::string parentHH, RandomStream randomIn) :
+    battery(config, randomIn.substream(0)) {
+    random = randomIn;
     NMI = nmi;
     name = newName;
     parentHousehold = parentHH;
@@ -58,6 +59,66 @@ Vehicle::Vehicle(Config* config, int nmi, std::string newName, std::string paren
 Vehicle::~Vehicle() {
 }
 
+void Vehicle::saveState(std::ostream &out) {
+    random.saveState(out);
+    utility::writeBinary(out, (int)location);
+    utility::writeBinary(out, travelProfile.name);
+    utility::writeBinary(out, travelProfile.isWeekday);
+    utility::writeBinary(out, (int)travelProfile.travelPairs.size());
+    for(std::list<travelPair_t>::iterator it = travelProfile.travelPairs.begin(); it != travelProfile.travelPairs.end(); ++it) {
+        it->time.saveState(out);
+        utility::writeBinary(out, it->distance);
+    }
+    utility::writeBinary(out, isConnected);
+    timeConnected.saveState(out);
+    timeChargeTarget.saveState(out);
+    utility::writeBinary(out, isCharging);
+    utility::writeBinary(out, chargeRate);
+    utility::writeBinary(out, activePower);
+    utility::writeBinary(out, inductivePower);
+    utility::writeBinary(out, capacitivePower);
+    utility::writeBinary(out, initSOC);
+    utility::writeBinary(out, distanceDriven);
+    utility::writeBinary(out, L);
+    utility::writeBinary(out, N);
+    utility::writeBinary(out, P);
+    utility::writeBinary(out, switchon);
+    battery.saveState(out);
+}
+
+void Vehicle::loadState(std::istream &in) {
+    int loc, numPairs;
+    travelPair_t travelPair;
+    
+    random.loadState(in);
+    utility::readBinary(in, loc);
+    location = (VehicleLocation)loc;
+    utility::readBinary(in, travelProfile.name);
+    utility::readBinary(in, travelProfile.isWeekday);
+    utility::readBinary(in, numPairs);
+    travelProfile.travelPairs.clear();
+    for(int i=0; i<numPairs; i++) {
+        travelPair.time.loadState(in);
+        utility::readBinary(in, travelPair.distance);
+        travelProfile.travelPairs.push_back(travelPair);
+    }
+    utility::readBinary(in, isConnected);
+    timeConnected.loadState(in);
+    timeChargeTarget.loadState(in);
+    utility::readBinary(in, isCharging);
+    utility::readBinary(in, chargeRate);
+    utility::readBinary(in, activePower);
+    utility::readBinary(in, inductivePower);
+    utility::readBinary(in, capacitivePower);
+    utility::readBinary(in, initSOC);
+    utility::readBinary(in, distanceDriven);
+    utility::readBinary(in, L);
+    utility::readBinary(in, N);
+    utility::readBinary(in, P);
+    utility::readBinary(in, switchon);
+    battery.loadState(in);
+}
+
 std::string Vehicle::getName() {
     return name;
 }
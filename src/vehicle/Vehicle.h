@@ -85,6 +85,9 @@ public:
     
     /** The vehicle battery. */
     Battery battery;
+    
+    /** Random stream of this vehicle (e.g. for travel profile selection). */
+    RandomStream random;
 
     /** Vehicle location: Home / Away / Other? */
     VehicleLocation location;
@@ -131,8 +134,9 @@ public:
     bool switchon;
     
 public:
-    /** Constructor */
-    Vehicle(Config* config, int nmi, std::string newName, std::string newParentHH);
+    /** Constructor.  All randomness of this vehicle (including its battery)
+      * is derived from the given stream. */
+    Vehicle(Config* config, int nmi, std::string newName, std::string newParentHH, RandomStream random);
     
     /** Destructor */
     virtual ~Vehicle();
@@ -164,6 +168,13 @@ public:
     /** Assign a new travel profile to this vehicle. */
     void setTravelProfile(vehicleRecord_t vr);
     
+    /** Write state (location, remaining travel profile, charging, battery,
+      * random stream) to checkpoint. */
+    void saveState(std::ostream &out);
+    
+    /** Read state from checkpoint. */
+    void loadState(std::istream &in);
+    
     /** Recharge vehicle battery. */
     void rechargeBattery();
     
@@ -0,0 +1,609 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <new>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <boost/filesystem.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "../src/simulator/Config.h"
+#include "../src/utility/Utility.h"
+#include "../src/utility/Power.h"
+#include "../src/utility/DateTime.h"
+#include "../src/battery/Battery.h"
+#include "../src/household/Household.h"
+#include "../src/household/HouseholdDemandModel.h"
+#include "../src/household/DemandProfileCache.h"
+#include "../src/vehicle/Vehicle.h"
+#include "../src/vehicle/TrafficModel.h"
+#include "../src/gridmodel/GridModel.h"
+#include "../src/loadflow/NativeInterface.h"
+#include "../src/charging/ChargingUncontrolled.h"
+
+/** possim_bench:  Microbenchmarks of the hot primitives of a simulation, each
+ *  run in isolation.  Reports time per operation and heap allocations per 
+ *  operation.  Run from the POSSIM root directory (configs/ and data/ are 
+ *  read from there).  An optional argument only runs benchmarks whose name
+ *  contains it, e.g. "possim_bench DateTime".
+ * 
+ *  "possim_bench --check" instead runs consistency checks of the fast load
+ *  flow paths against full load flows, and exits with status 1 if any fails. */
+
+
+// Count heap allocations (the benchmarks run on a single thread)
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_NOTHROW noexcept
+#else
+#define BENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define BENCH_NOTHROW throw()
+#endif
+
+static long numAllocations = 0;
+
+void* operator new(std::size_t size) BENCH_THROW_BAD_ALLOC {
+    numAllocations++;
+    void* p = std::malloc(size > 0 ? size : 1);
+    if(p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) BENCH_THROW_BAD_ALLOC {
+    return operator new(size);
+}
+
+void operator delete(void* p) BENCH_NOTHROW {
+    std::free(p);
+}
+
+void operator delete[](void* p) BENCH_NOTHROW {
+    std::free(p);
+}
+
+
+/** Results are accumulated here, so the compiler cannot optimise work away */
+static volatile double sink = 0;
+
+/** Console output of the code under test is sent here (a closed stream) */
+static std::ofstream nullStream;
+
+/** A benchmark performs the given number of operations */
+typedef void (*BenchFunction)(long numOps);
+
+/** A check returns the largest deviation found from the reference result */
+typedef double (*CheckFunction)();
+
+
+/** Run benchmark with increasing numbers of operations until it takes at 
+  * least minTime seconds, then report time and allocations per operation. */
+void runBenchmark(std::string name, BenchFunction function, std::string filter, double minTime) {
+    if(name.find(filter) == std::string::npos)
+        return;
+    
+    long numOps = 1;
+    double elapsed = 0;
+    long allocations = 0;
+    std::streambuf* coutBuffer = std::cout.rdbuf();
+    while(true) {
+        std::cout.rdbuf(nullStream.rdbuf());
+        long allocationsBefore = numAllocations;
+        boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+        function(numOps);
+        elapsed = (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds() / 1e6;
+        allocations = numAllocations - allocationsBefore;
+        std::cout.rdbuf(coutBuffer);
+        
+        if(elapsed >= minTime || numOps >= (1L << 40))
+            break;
+        numOps = elapsed > 0.01 ? (long)(numOps * 1.2 * minTime / elapsed) + 1 : numOps * 10;
+    }
+    
+    std::cout << "  " << std::setw(40) << std::left << name
+              << std::setw(12) << std::right << numOps
+              << std::setiosflags(std::ios::fixed) << std::setprecision(1)
+              << std::setw(16) << elapsed * 1e9 / numOps
+              << std::setprecision(2)
+              << std::setw(14) << (double)allocations / numOps << std::endl;
+}
+
+
+/** Run check, report largest deviation, return true if within tolerance. */
+bool runCheck(std::string name, CheckFunction function, double tolerance) {
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullStream.rdbuf());
+    double deviation = function();
+    std::cout.rdbuf(coutBuffer);
+    
+    bool passed = (deviation <= tolerance);
+    std::cout << "  " << std::setw(40) << std::left << name
+              << std::setiosflags(std::ios::scientific) << std::setprecision(2)
+              << std::setw(12) << std::right << deviation
+              << std::setw(12) << tolerance
+              << std::resetiosflags(std::ios::scientific)
+              << (passed ? "    OK" : "    FAILED") << std::endl;
+    return passed;
+}
+
+
+/*   FIXTURES   */
+
+/** Native solver without batch solution, so that scenarios are solved one
+  * at a time (as by interfaces without a batch solver). */
+class SequentialInterface : public NativeInterface {
+public:
+    SequentialInterface(Config* config) : NativeInterface(config) {}
+    bool runBatchSim(int numScenarios, double* active, double* inductive, 
+                     double* capacitive, double* houseV) {
+        return false;
+    }
+};
+
+Config* config;
+Battery* battery;
+Household* dayHousehold;
+Household* yearHousehold;
+std::string csvLine;
+std::map<std::string,Vehicle*> fleet;
+TrafficModel* fleetTraffic;
+GridModel* gridModel;
+LoadFlowInterface* gridLoadflow;
+GridModel* sequentialModel;
+TrafficModel* gridTraffic;
+ChargingUncontrolled* gridCharger;
+DateTime benchTime;
+boost::filesystem::path tempDir;
+
+void setupFixtures() {
+    config = new Config();
+    config->setConfigVar("loadflowsimulator", "native");
+    config->setConfigVar("showdebug", "no");
+    config->setConfigVar("randomseed", "1");
+    config->setConfigVar("evpenetration", "50");
+    
+    battery = new Battery(config, RandomStream(1, "battery", 0));
+    
+    // A 24-hour profile as read from the demand data directory (1-minute
+    // resolution in the examples)
+    HouseholdDemandModel demandModel(config);
+    std::map<std::string, Household*> houses;
+    dayHousehold = new Household();
+    dayHousehold->name = "HH_1_1";
+    dayHousehold->NMI = 1;
+    dayHousehold->setModelType(config->getString("demandmodel"));
+    houses[dayHousehold->name] = dayHousehold;
+    demandModel.assignProfiles(houses);
+    
+    // A year-long exact-time profile at 5-minute resolution
+    yearHousehold = new Household();
+    yearHousehold->setModelType("housespecific");
+    HouseholdDemandProfile* yearProfile = new HouseholdDemandProfile();
+    DateTime t;
+    t.set(0, 0, 1, 1, 2012);
+    for(int i=0; i<366*288; i++) {
+        S_Load load;
+        load.P = 500 + i%288;
+        load.Q = 100;
+        yearProfile->demand[t] = load;
+        t.increment(5);
+    }
+    yearProfile->buildIndex(false);
+    yearHousehold->demandProfile.reset(yearProfile);
+    
+    // A line of a demand data file
+    for(int i=0; i<48; i++)
+        csvLine += utility::double2string(123.456 + i) + (i < 47 ? "," : "");
+    
+    // A fleet of vehicles with travel records
+    DateTime start(config->getConfigVar("starttime").c_str());
+    for(int i=1; i<=1000; i++) {
+        std::string name = "HH_" + utility::int2string(i) + "_EV";
+        fleet[name] = new Vehicle(config, i, name, "HH_" + utility::int2string(i), RandomStream(1, "vehicle", i));
+    }
+    fleetTraffic = new TrafficModel(config);
+    fleetTraffic->initialise(start, fleet);
+    
+    // The example network, solved by the native load flow solver
+    tempDir = boost::filesystem::temp_directory_path() / "possim_bench";
+    boost::filesystem::create_directories(tempDir);
+    gridLoadflow = new NativeInterface(config);
+    gridModel = new GridModel();
+    gridModel->initialise(config, gridLoadflow, 1);
+    demandModel.assignProfiles(gridModel->households);
+    gridModel->addVehicles(config);
+    gridModel->setLogDir(tempDir.string() + "/");
+    
+    // The same network, solving scenarios one at a time
+    sequentialModel = new GridModel();
+    sequentialModel->initialise(config, new SequentialInterface(config), 1);
+    demandModel.assignProfiles(sequentialModel->households);
+    sequentialModel->addVehicles(config);
+    sequentialModel->setLogDir(tempDir.string() + "/");
+    gridTraffic = new TrafficModel(config);
+    gridTraffic->initialise(start, gridModel->vehicles);
+    gridCharger = new ChargingUncontrolled(config, *gridModel);
+}
+
+
+/*   BENCHMARKS   */
+
+void benchPhasorArithmetic(long numOps) {
+    Phasor a(240, 0), b(1.5, -30);
+    for(long i=0; i<numOps; i++) {
+        Phasor c = a.plus(b).times(b).dividedBy(a).minus(b);
+        sink += c.real();
+    }
+}
+
+void benchSymmetricalComponents(long numOps) {
+    Phasor vAB(400, 30), vBC(398, -91), vCA(402, 151), v0, v1, v2;
+    for(long i=0; i<numOps; i++) {
+        power::symmetricalComponents(vAB, vBC, vCA, v0, v1, v2);
+        sink += v2.getAmplitude();
+    }
+}
+
+void benchPhaseUnbalance(long numOps) {
+    Phasor vAB(400, 30), vBC(398, -91), vCA(402, 151);
+    for(long i=0; i<numOps; i++)
+        sink += power::calculatePhaseUnbalance(vAB, vBC, vCA);
+}
+
+void benchBatteryRecharge(long numOps) {
+    battery->SOC = 20;
+    for(long i=0; i<numOps; i++) {
+        battery->recharge(3450);
+        if(battery->SOC > 90)
+            battery->SOC = 20;
+    }
+    sink += battery->SOC;
+}
+
+void benchBatteryDischarge(long numOps) {
+    battery->SOC = 90;
+    for(long i=0; i<numOps; i++) {
+        battery->discharge(1.0);
+        if(battery->SOC < 20)
+            battery->SOC = 90;
+    }
+    sink += battery->SOC;
+}
+
+void benchDemandDayProfile(long numOps) {
+    DateTime start(config->getConfigVar("starttime").c_str());
+    DateTime t = start;
+    for(long i=0; i<numOps; i++) {
+        sink += dayHousehold->getDemandAt(t).P;
+        t.increment(5);
+        if(i%288 == 287)
+            t = start;
+    }
+}
+
+void benchDemandYearProfile(long numOps) {
+    DateTime t;
+    t.set(0, 0, 1, 1, 2012);
+    for(long i=0; i<numOps; i++) {
+        sink += yearHousehold->getDemandAt(t).P;
+        t.increment(7*60+5);    // cover the whole year, at varying times of day
+        if(t.year > 2012)
+            t.set(0, 0, 1, 1, 2012);
+    }
+}
+
+void benchDateTimeCompare(long numOps) {
+    DateTime a, b;
+    b.increment(30);
+    int n = 0;
+    for(long i=0; i<numOps; i++) {
+        n += a < b;
+        n += a.isEarlierThan(b);
+        n += a.equals(b);
+        n += a.isEarlierInDayThan(b);
+    }
+    sink += n;
+}
+
+void benchDateTimeIncrement(long numOps) {
+    DateTime t;
+    for(long i=0; i<numOps; i++)
+        t.increment(5);
+    sink += t.minute;
+}
+
+void benchTokenize(long numOps) {
+    std::vector<std::string> tokens;
+    for(long i=0; i<numOps; i++) {
+        tokens.clear();
+        utility::tokenize(csvLine, tokens, ",");
+        sink += tokens.size();
+    }
+}
+
+void benchString2Double(long numOps) {
+    std::string value = "1234.5678";
+    for(long i=0; i<numOps; i++)
+        sink += utility::string2double(value);
+}
+
+void benchTrafficUpdate(long numOps) {
+    for(long i=0; i<numOps; i++) {
+        fleetTraffic->update(benchTime, fleet);
+        benchTime.increment(config->getInt("simulationinterval"));
+    }
+}
+
+void benchGridInterval(long numOps) {
+    for(long i=0; i<numOps; i++) {
+        gridTraffic->update(benchTime, gridModel->vehicles);
+        gridModel->updateVehicleBatteries();
+        gridModel->generateAllHouseholdLoads(benchTime);
+        gridModel->resetVehicleLoads();
+        gridCharger->setAllChargeRates(benchTime, *gridModel);
+        gridModel->generateAllVehicleLoads();
+        gridModel->runLoadFlow();
+        benchTime.increment(config->getInt("simulationinterval"));
+    }
+}
+
+
+
+/*   CHECKS   */
+
+/** Solve one interval of the given grid model, as the simulator would. */
+void solveCheckInterval(GridModel* model) {
+    DateTime time(config->getConfigVar("starttime").c_str());
+    time.hour = 19;
+    model->generateAllHouseholdLoads(time);
+    model->resetVehicleLoads();
+    model->runLoadFlow();
+}
+
+/** Several load scenarios of the given (solved) grid model:  household 
+  * loads are scaled, and every other vehicle charges. */
+int makeScenarios(GridModel* model, std::vector<double> &active, std::vector<double> &inductive, std::vector<double> &capacitive) {
+    int numScenarios = 8;
+    int numHouses = model->households.size();
+    int numLoads = numHouses + model->vehicles.size();
+    active.resize(numScenarios*numLoads);
+    inductive.resize(numScenarios*numLoads);
+    capacitive.resize(numScenarios*numLoads);
+    
+    const double* houseActive = model->getHouseholdActive();
+    const double* houseInductive = model->getHouseholdInductive();
+    const double* houseCapacitive = model->getHouseholdCapacitive();
+    for(int s=0; s<numScenarios; s++) {
+        double scale = 0.5 + 0.25*s;
+        for(int n=0; n<numLoads; n++) {
+            int i = s*numLoads + n;
+            if(n < numHouses) {
+                active[i] = scale*houseActive[n] + 0.001;
+                inductive[i] = scale*houseInductive[n];
+                capacitive[i] = scale*houseCapacitive[n];
+            }
+            else {
+                active[i] = ((n+s)%2 == 0) ? 3000 : 0.001;
+                inductive[i] = 0;
+                capacitive[i] = 0;
+            }
+        }
+    }
+    return numScenarios;
+}
+
+/** Household voltages of load scenarios solved in batch, against the same
+  * scenarios solved one at a time by full load flows. */
+double checkBatchLoadFlow() {
+    solveCheckInterval(gridModel);
+    std::vector<double> active, inductive, capacitive, batchV;
+    int numScenarios = makeScenarios(gridModel, active, inductive, capacitive);
+    gridModel->runBatchLoadFlow(numScenarios, active, inductive, capacitive, batchV);
+    
+    int numHouses = gridModel->households.size();
+    int numLoads = active.size() / numScenarios;
+    double maxDeviation = 0;
+    for(int s=0; s<numScenarios; s++) {
+        gridLoadflow->setDemand(&active[s*numLoads], &inductive[s*numLoads], &capacitive[s*numLoads], numLoads);
+        gridLoadflow->runSim();
+        gridLoadflow->getOutputs("", gridModel->networkData, gridModel->households, gridModel->lineSegments, gridModel->poles);
+        int h = 0;
+        for(std::map<std::string,Household*>::iterator it = gridModel->households.begin(); it != gridModel->households.end(); ++it, ++h)
+            maxDeviation = std::max(maxDeviation, std::abs(batchV[s*numHouses+h] - it->second->V_RMS));
+    }
+    return maxDeviation;
+}
+
+/** Household voltages of an interval before and after load scenarios have 
+  * been solved one at a time, which must leave the interval's solution. */
+double checkSequentialBatchRestore() {
+    solveCheckInterval(sequentialModel);
+    std::vector<double> before;
+    for(std::map<std::string,Household*>::iterator it = sequentialModel->households.begin(); it != sequentialModel->households.end(); ++it)
+        before.push_back(it->second->V_RMS);
+    
+    std::vector<double> active, inductive, capacitive, batchV;
+    int numScenarios = makeScenarios(sequentialModel, active, inductive, capacitive);
+    sequentialModel->runBatchLoadFlow(numScenarios, active, inductive, capacitive, batchV);
+    
+    double maxDeviation = 0;
+    int h = 0;
+    for(std::map<std::string,Household*>::iterator it = sequentialModel->households.begin(); it != sequentialModel->households.end(); ++it, ++h)
+        maxDeviation = std::max(maxDeviation, std::abs(before[h] - it->second->V_RMS));
+    return maxDeviation;
+}
+
+/** Household voltages estimated from sensitivities for a few vehicles 
+  * starting to charge, against a full load flow with those vehicles. */
+double checkSensitivities() {
+    solveCheckInterval(gridModel);
+    
+    // Households in the order used by the estimate
+    std::map<int,int> houseIndex;
+    int h = 0;
+    for(std::map<std::string,Household*>::iterator it = gridModel->households.begin(); it != gridModel->households.end(); ++it, ++h)
+        houseIndex[it->second->NMI] = h;
+    
+    std::vector<double> deltaP(gridModel->households.size(), 0);
+    std::vector<double> deltaQ(gridModel->households.size(), 0);
+    double chargeRate = config->getDouble("maxchargerate");
+    int v = 0;
+    for(std::map<std::string,Vehicle*>::iterator it = gridModel->vehicles.begin(); it != gridModel->vehicles.end() && v < 3; ++it, ++v) {
+        it->second->setPowerDemand(chargeRate, 0, 0);
+        deltaP[houseIndex[it->second->NMI]] += chargeRate;
+    }
+    std::vector<double> estimate = gridModel->estimateVoltages(deltaP, deltaQ);
+    gridModel->runLoadFlow();
+    gridModel->resetVehicleLoads();
+    
+    double maxDeviation = 0;
+    h = 0;
+    for(std::map<std::string,Household*>::iterator it = gridModel->households.begin(); it != gridModel->households.end(); ++it, ++h)
+        maxDeviation = std::max(maxDeviation, std::abs(estimate[h] - it->second->V_RMS));
+    return maxDeviation;
+}
+
+/** Number of lookups in a profile that differ from the first of the given
+  * entries at or after the time looked up, at 1-minute steps from the given
+  * time to an hour past the last entry. */
+double countProfileMismatches(const HouseholdDemandProfile &profile, const HouseholdDemandProfile &entries, DateTime t) {
+    double mismatches = 0;
+    DateTime last = entries.demand.rbegin()->first;
+    last.increment(60);
+    for(; t < last; t.increment(1)) {
+        std::map<DateTime, S_Load>::const_iterator entry = entries.demand.begin();
+        while(entry != entries.demand.end() && DateTime(entry->first).minutesSinceEpoch() < t.minutesSinceEpoch())
+            ++entry;
+        const S_Load* found = profile.find(t);
+        if(entry == entries.demand.end() ? found != NULL : (found == NULL || found->P != entry->second.P))
+            mismatches++;
+    }
+    return mismatches;
+}
+
+/** Demand profile lookups, in a regular profile (indexed in slots) and in 
+  * one with an entry off its grid (searched), against the entries;  both as
+  * built and as read back from a profile cache. */
+double checkProfileLookup() {
+    HouseholdDemandProfile* regular = new HouseholdDemandProfile();
+    HouseholdDemandProfile* irregular = new HouseholdDemandProfile();
+    DateTime start, t;
+    start.set(0, 0, 1, 1, 2012);
+    t.set(1, 0, 1, 1, 2012);
+    for(int i=0; i<7*48; i++) {
+        S_Load load;
+        load.P = i;
+        load.Q = 0;
+        regular->demand[t] = load;
+        irregular->demand[t] = load;
+        t.increment(30);
+    }
+    t.increment(1);
+    S_Load load;
+    load.P = -1;
+    load.Q = 0;
+    irregular->demand[t] = load;
+    regular->buildIndex(false);
+    irregular->buildIndex(false);
+    regular->name = "regular";
+    irregular->name = "irregular";
+    
+    std::map<std::string, HouseholdDemandProfilePtr> profiles, cached;
+    profiles[regular->name] = HouseholdDemandProfilePtr(regular);
+    profiles[irregular->name] = HouseholdDemandProfilePtr(irregular);
+    std::string cacheFile = (tempDir / "demandcache.bin").string();
+    std::vector<std::string> noSources;
+    if(!DemandProfileCache::write(cacheFile, noSources, false, profiles) ||
+       !DemandProfileCache::read(cacheFile, noSources, false, cached))
+        return 1;
+    
+    return countProfileMismatches(*regular, *regular, start) 
+            + countProfileMismatches(*irregular, *irregular, start)
+            + countProfileMismatches(*cached["regular"], *regular, start) 
+            + countProfileMismatches(*cached["irregular"], *irregular, start)
+            + (regular->resolution == 30 ? 0 : 1) + (irregular->resolution == 0 ? 0 : 1);
+}
+
+int main(int argc, char ** argv) 
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+    double minTime = 0.5;
+    
+    std::cout << "Setting up benchmarks ..." << std::endl;
+    std::streambuf* coutBuffer = std::cout.rdbuf(nullStream.rdbuf());
+    setupFixtures();
+    std::cout.rdbuf(coutBuffer);
+    
+    if(filter == "--check") {
+        // Deviations in V; load flows converge to within loadflowtolerance,
+        // and sensitivities are linearised (a few volts drop, within 0.1 V)
+        double tolerance = 10*config->getDouble("loadflowtolerance");
+        bool passed = true;
+        std::cout << std::endl
+                  << "  Check                                     Deviation   Tolerance" << std::endl
+                  << "  -----------------------------------------------------------------------" << std::endl;
+        passed &= runCheck("Batch vs sequential load flow (V)",   checkBatchLoadFlow,             tolerance);
+        passed &= runCheck("State after one-by-one batch (V)",    checkSequentialBatchRestore,    tolerance);
+        passed &= runCheck("Sensitivity estimate vs load flow (V)", checkSensitivities,        0.1);
+        passed &= runCheck("Demand profile lookup (mismatches)",  checkProfileLookup,             0);
+        return passed ? 0 : 1;
+    }
+    
+    std::cout << std::endl
+              << "  Benchmark                                      Ops            ns/op     allocs/op" << std::endl
+              << "  ----------------------------------------------------------------------------------" << std::endl;
+    runBenchmark("Phasor arithmetic",                   benchPhasorArithmetic,      filter, minTime);
+    runBenchmark("power::symmetricalComponents",        benchSymmetricalComponents, filter, minTime);
+    runBenchmark("power::calculatePhaseUnbalance",      benchPhaseUnbalance,        filter, minTime);
+    runBenchmark("Battery::recharge",                   benchBatteryRecharge,       filter, minTime);
+    runBenchmark("Battery::discharge",                  benchBatteryDischarge,      filter, minTime);
+    runBenchmark("Household::getDemandAt (24 hours)",   benchDemandDayProfile,      filter, minTime);
+    runBenchmark("Household::getDemandAt (1 year)",     benchDemandYearProfile,     filter, minTime);
+    runBenchmark("DateTime compare (x4)",               benchDateTimeCompare,       filter, minTime);
+    runBenchmark("DateTime::increment",                 benchDateTimeIncrement,     filter, minTime);
+    runBenchmark("utility::tokenize (48 values)",       benchTokenize,              filter, minTime);
+    runBenchmark("utility::string2double",              benchString2Double,         filter, minTime);
+    benchTime = DateTime(config->getConfigVar("starttime").c_str());
+    runBenchmark("TrafficModel::update (1000 vehicles)", benchTrafficUpdate,        filter, minTime);
+    benchTime = DateTime(config->getConfigVar("starttime").c_str());
+    runBenchmark("GridModel interval (native)",         benchGridInterval,          filter, minTime);
+    
+    return 0;
+}
@@ -0,0 +1,95 @@
+/* 
+Software License Agreement (BSD License)
+
+Copyright (c) 2013, Julian de Hoog <julian@dehoog.ca>
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+
+ * Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above
+   copyright notice, this list of conditions and the following
+   disclaimer in the documentation and/or other materials provided
+   with the distribution.
+ * The name of the author may not be used to endorse or promote 
+   products derived from this software without specific prior 
+   written permission from the author.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE. 
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "../src/simulator/LogFile.h"
+
+/** log2csv:  Convert binary log files (written with logformat "binary") to the
+ *  equivalent CSV files, written alongside them.  Arguments are log files, or
+ *  log directories in which all binary log files are converted.  Compressed
+ *  binary files (.bin.gz) are decompressed on the fly. */
+
+
+/** Convert one file, report result. Returns false on failure. */
+bool convert(boost::filesystem::path file)
+{
+    boost::filesystem::path csvFile = file;
+    if(csvFile.extension().string() == ".gz")
+        csvFile.replace_extension("");
+    csvFile.replace_extension(".csv");
+    
+    std::cout << "Converting " << file.string() << " ...";
+    std::cout.flush();
+    if(!LogFile::convertToCSV(file.string(), csvFile.string())) {
+        std::cout << " failed, not a POSSIM binary log file" << std::endl;
+        return false;
+    }
+    std::cout << " OK" << std::endl;
+    return true;
+}
+
+int main(int argc, char ** argv) 
+{
+    bool success = true;
+    
+    if(argc < 2) {
+        std::cout << std::endl << "USAGE:  " << *argv << " <log file or directory> ..." << std::endl << std::endl;
+        return -1;
+    }
+    
+    for(int i=1; i<argc; i++) {
+        boost::filesystem::path path(argv[i]);
+        
+        if(!boost::filesystem::exists(path)) {
+            std::cout << "Error: " << path.string() << " does not exist" << std::endl;
+            success = false;
+        }
+        
+        else if(boost::filesystem::is_directory(path)) {
+            for(boost::filesystem::directory_iterator it(path); it != boost::filesystem::directory_iterator(); ++it)
+                if(it->path().extension().string() == ".bin" ||
+                   it->path().stem().extension().string() == ".bin")
+                    success &= convert(it->path());
+        }
+        
+        else
+            success &= convert(path);
+    }
+    
+    return success ? 0 : 1;
+}